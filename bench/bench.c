@@ -0,0 +1,1046 @@
+#include "src/internal.h"
+
+#include <deps/cmd_arger.c>
+#include <deps/utf8proc.c>
+#include <errno.h>
+#include <math.h>
+
+#include "src/gen_syn.c"
+#include "src/compiler.c"
+#include "src/lexer.c"
+#include "src/misc.c"
+#include "src/util.c"
+
+//
+// tekc_bench generates a synthetic tek project and measures how fast tekc gets through it.
+// it is built by running the build script with --bench, see build_script.c.
+//
+// the project is a tree of files, where each file imports the next fan_out files.
+// the files are made out of the same constructs that are in tests/build_pass and tests/run_pass.
+//
+// the modes that are measured:
+//     lex    - TekLexer_lex on every file, one after the other on the main thread.
+//     syn    - TekLexer_lex and then TekGenSyn_gen_file on every file, one after the other on the main thread.
+//     intern - TekCompiler_strtab_get_or_insert on every identifier and string token of the project,
+//              in the order they are lexed, into a new string table.
+//     full   - a whole compile with TekCompiler_compile_start, for every worker count from 1 up to workers_max.
+//              this is run with the source files in the page cache (warm) and dropped from it (cold).
+//
+// lex is also run cold, once for each of the ways TekCompiler_file_get_or_create can load the code of a file,
+// see TekBenchLoad. these time loading each file and then lexing it, so the results show which way is the
+// fastest for the size of the corpus files. use --procs_per_file to change the size of the files, this is
+// how tek_file_code_read_max_size and tek_file_code_populate_max_size were picked.
+//
+// lex and syn run the same job code that a worker does, but without the job system and threads.
+// they run after a full compile has found all of the files, so the string table is already filled in.
+//
+// the results are printed as JSON, see TekBench_report.
+//
+// with --gate only lex, syn and intern are run. passing --baseline compares them to the results in that file,
+// and the exit code is 1 when any of them are significantly slower, see TekBench_gate.
+// build_script.c runs this with --bench_gate against bench/baseline.json.
+//
+// with --containers the project is not generated, and the microbenchmarks of the containers are run instead,
+// see bench/containers.c.
+//
+// with --floats the project is not generated either, and the float literal parser is checked against strtod instead,
+// see bench/floats.c.
+//
+// with --relex the project is generated and compiled once, and then TekLexer_relex is checked against TekLexer_lex
+// and timed against it on the project's files, see bench/relex.c.
+//
+
+typedef struct TekBenchArgs TekBenchArgs;
+struct TekBenchArgs {
+	char* corpus_dir;
+	uint32_t files_count;
+	uint32_t fan_out;
+	uint32_t procs_per_file;
+	uint32_t lines_per_proc;
+	uint32_t idents_per_line;
+	uint32_t literal_pct;
+	uint32_t float_pct;
+	uint32_t comment_pct;
+	uint64_t seed;
+	uint32_t iters;
+	uint32_t workers_max;
+	uint32_t gate_pct;
+};
+
+//===========================================================================================
+//
+//
+// corpus generator
+//
+//
+//===========================================================================================
+
+typedef struct TekBenchGen TekBenchGen;
+struct TekBenchGen {
+	TekBenchArgs* args;
+	uint64_t rng;
+	TekStk(char) code;
+};
+
+static uint32_t TekBenchGen_rand(TekBenchGen* gen) {
+	// xorshift64*
+	gen->rng ^= gen->rng >> 12;
+	gen->rng ^= gen->rng << 25;
+	gen->rng ^= gen->rng >> 27;
+	return (gen->rng * 0x2545F4914F6CDD1Dull) >> 32;
+}
+
+static uint32_t TekBenchGen_range(TekBenchGen* gen, uint32_t count) {
+	return TekBenchGen_rand(gen) % count;
+}
+
+static TekBool TekBenchGen_chance(TekBenchGen* gen, uint32_t pct) {
+	return TekBenchGen_range(gen, 100) < pct;
+}
+
+//
+// identifiers and strings are picked from small sets, so the string table stays about the same size
+// no matter how big the project is. like a real project, the same names come up over and over.
+static char* TekBenchGen_local_names[] = {
+	"num", "one", "two", "count", "idx", "value", "ptr", "total",
+	"offset", "size", "len", "width", "height", "x", "y", "result",
+};
+static char* TekBenchGen_strings[] = {
+	"test", "hello world", "Vec2", "an error has occurred", "", "path/to/file.tek",
+};
+static char* TekBenchGen_comment_words[] = {
+	"the", "value", "is", "checked", "here", "so", "that", "we", "do", "not", "overflow", "TODO", "index", "of", "next",
+};
+static char* TekBenchGen_binary_ops[] = { "+", "-", "*", "/", "%" };
+static char* TekBenchGen_assign_ops[] = { "+=", "-=", "*=", "/=", "%=" };
+static char* TekBenchGen_unary_ops[] = { ".&", ".*", ".-", ".!" };
+#define TekBenchGen_pick(gen, array) (array)[TekBenchGen_range(gen, sizeof(array) / sizeof(*(array)))]
+
+static void TekBenchGen_local(TekBenchGen* gen) {
+	TekStk_push_str(&gen->code, TekBenchGen_pick(gen, TekBenchGen_local_names));
+}
+
+//
+// a float literal for each of the ways _TekLexer_parse_float can work out its value.
+static void TekBenchGen_float(TekBenchGen* gen) {
+	switch (TekBenchGen_range(gen, 4)) {
+		case 0:
+			// a short mantissa and power of ten, which is the exact double operation.
+			TekStk_push_str_fmt(&gen->code, "%u.%u", TekBenchGen_range(gen, 1000), TekBenchGen_range(gen, 100));
+			break;
+		case 1:
+			// up to 18 significant digits, so the mantissa is too big to be exact in a double.
+			TekStk_push_str_fmt(&gen->code, "%u.%09u%06u", TekBenchGen_range(gen, 1000), TekBenchGen_range(gen, 1000000000), TekBenchGen_range(gen, 1000000));
+			break;
+		case 2: {
+			// a power of ten that is too small to be exact in a double.
+			uint32_t zeros_count = 22 + TekBenchGen_range(gen, 20);
+			TekStk_push_str(&gen->code, "0.");
+			for (uint32_t i = 0; i < zeros_count; i += 1) {
+				TekStk_push_str(&gen->code, "0");
+			}
+			TekStk_push_str_fmt(&gen->code, "%u", 1 + TekBenchGen_range(gen, 1000000));
+			break;
+		};
+		case 3:
+			// more than 19 significant digits, which is left to strtod.
+			TekStk_push_str_fmt(&gen->code, "%u.%09u%09u%09u", 1 + TekBenchGen_range(gen, 1000),
+				TekBenchGen_range(gen, 1000000000), TekBenchGen_range(gen, 1000000000), TekBenchGen_range(gen, 1000000000));
+			break;
+	}
+}
+
+static void TekBenchGen_literal(TekBenchGen* gen) {
+	//
+	// the chance is only rolled when there is a float_pct, so it does not change the default corpus.
+	if (gen->args->float_pct && TekBenchGen_chance(gen, gen->args->float_pct)) {
+		TekBenchGen_float(gen);
+		return;
+	}
+
+	switch (TekBenchGen_range(gen, 8)) {
+		case 0: case 1: case 2:
+			TekStk_push_str_fmt(&gen->code, "%u", TekBenchGen_range(gen, 1000));
+			break;
+		case 3:
+			TekStk_push_str_fmt(&gen->code, "%u", TekBenchGen_rand(gen));
+			break;
+		case 4:
+			TekStk_push_str_fmt(&gen->code, "0x%x", TekBenchGen_rand(gen));
+			break;
+		case 5: case 6:
+			TekStk_push_str_fmt(&gen->code, "%u.%u", TekBenchGen_range(gen, 1000), TekBenchGen_range(gen, 100));
+			break;
+		case 7:
+			TekStk_push_str_fmt(&gen->code, "\"%s\"", TekBenchGen_pick(gen, TekBenchGen_strings));
+			break;
+	}
+}
+
+static void TekBenchGen_operand(TekBenchGen* gen) {
+	if (TekBenchGen_chance(gen, gen->args->literal_pct)) {
+		TekBenchGen_literal(gen);
+	} else {
+		TekBenchGen_local(gen);
+	}
+}
+
+static void TekBenchGen_expr(TekBenchGen* gen, uint32_t operands_count) {
+	for (uint32_t i = 0; i < operands_count; i += 1) {
+		if (i) {
+			TekStk_push_str_fmt(&gen->code, " %s ", TekBenchGen_pick(gen, TekBenchGen_binary_ops));
+		}
+
+		if (i + 1 < operands_count && TekBenchGen_range(gen, 6) == 0) {
+			TekStk_push_str(&gen->code, "(");
+			TekBenchGen_operand(gen);
+			TekStk_push_str_fmt(&gen->code, " %s ", TekBenchGen_pick(gen, TekBenchGen_binary_ops));
+			TekBenchGen_operand(gen);
+			TekStk_push_str(&gen->code, ")");
+			i += 1;
+		} else {
+			TekBenchGen_operand(gen);
+		}
+	}
+}
+
+static void TekBenchGen_comment(TekBenchGen* gen) {
+	uint32_t words_count = 2 + TekBenchGen_range(gen, 8);
+	for (uint32_t i = 0; i < words_count; i += 1) {
+		TekStk_push_str_fmt(&gen->code, i ? " %s" : "%s", TekBenchGen_pick(gen, TekBenchGen_comment_words));
+	}
+}
+
+static void TekBenchGen_stmt(TekBenchGen* gen) {
+	TekBenchArgs* args = gen->args;
+	uint32_t operands_count = args->idents_per_line ? args->idents_per_line : 1;
+
+	if (TekBenchGen_chance(gen, args->comment_pct / 4)) {
+		TekStk_push_str(&gen->code, "\t// ");
+		TekBenchGen_comment(gen);
+		TekStk_push_str(&gen->code, "\n");
+	}
+
+	TekStk_push_str(&gen->code, "\t");
+	switch (TekBenchGen_range(gen, 8)) {
+		case 0:
+			TekBenchGen_local(gen);
+			TekStk_push_str(&gen->code, TekBenchGen_range(gen, 2) ? ": var mut U32 = " : ": var = ");
+			TekBenchGen_expr(gen, operands_count);
+			break;
+		case 1:
+		case 2:
+			TekBenchGen_local(gen);
+			TekStk_push_str(&gen->code, " = ");
+			TekBenchGen_expr(gen, operands_count);
+			break;
+		case 3:
+			TekBenchGen_local(gen);
+			TekStk_push_str_fmt(&gen->code, " %s ", TekBenchGen_pick(gen, TekBenchGen_assign_ops));
+			TekBenchGen_expr(gen, operands_count);
+			break;
+		case 4:
+			TekStk_push_str(&gen->code, "assert(");
+			TekBenchGen_expr(gen, operands_count);
+			TekStk_push_str(&gen->code, " == ");
+			TekBenchGen_literal(gen);
+			TekStk_push_str(&gen->code, ")");
+			break;
+		case 5:
+			TekStk_push_str_fmt(&gen->code, "proc_%u(", TekBenchGen_range(gen, args->procs_per_file));
+			for (uint32_t i = 0; i < operands_count; i += 1) {
+				if (i) TekStk_push_str(&gen->code, ", ");
+				TekBenchGen_operand(gen);
+			}
+			TekStk_push_str(&gen->code, ")");
+			break;
+		case 6:
+			TekBenchGen_local(gen);
+			TekStk_push_str(&gen->code, " = ");
+			TekBenchGen_local(gen);
+			TekStk_push_str(&gen->code, TekBenchGen_pick(gen, TekBenchGen_unary_ops));
+			TekStk_push_str(&gen->code, TekBenchGen_pick(gen, TekBenchGen_unary_ops));
+			break;
+		case 7:
+			TekBenchGen_local(gen);
+			if (TekBenchGen_range(gen, 2)) {
+				TekStk_push_str(&gen->code, ": var = Vec2(x: ");
+				TekBenchGen_operand(gen);
+				TekStk_push_str(&gen->code, ", y: ");
+				TekBenchGen_operand(gen);
+				TekStk_push_str(&gen->code, ")");
+			} else {
+				TekStk_push_str(&gen->code, ".x = ");
+				TekBenchGen_expr(gen, operands_count);
+			}
+			break;
+	}
+
+	if (TekBenchGen_chance(gen, args->comment_pct)) {
+		TekStk_push_str(&gen->code, " // ");
+		TekBenchGen_comment(gen);
+	}
+	TekStk_push_str(&gen->code, "\n");
+}
+
+static void TekBenchGen_file_path(TekBenchGen* gen, uint32_t file_idx, char* path_out) {
+	if (file_idx == 0) {
+		snprintf(path_out, PATH_MAX, "%s/main.tek", gen->args->corpus_dir);
+	} else {
+		snprintf(path_out, PATH_MAX, "%s/file_%u.tek", gen->args->corpus_dir, file_idx);
+	}
+}
+
+static void TekBenchGen_file(TekBenchGen* gen, uint32_t file_idx) {
+	TekBenchArgs* args = gen->args;
+	TekStk_clear(&gen->code);
+	TekStk_push_str_fmt(&gen->code, "// generated by tekc_bench, file %u of %u\n\n", file_idx, args->files_count);
+
+	//
+	// the files make a tree where file n imports files n * fan_out + 1 up to n * fan_out + fan_out.
+	// the imports use absolute paths, as they are resolved from the working directory of the compiler.
+	uint64_t first_child_idx = (uint64_t)file_idx * args->fan_out + 1;
+	for (uint64_t i = first_child_idx; i < first_child_idx + args->fan_out && i < args->files_count; i += 1) {
+		char path[PATH_MAX];
+		TekBenchGen_file_path(gen, i, path);
+		TekStk_push_str_fmt(&gen->code, "#import \"%s\"\n", path);
+	}
+
+	TekStk_push_str(&gen->code, "\nVec2: struct {\n\tx: F32\n\ty: F32\n}\n\n");
+	TekStk_push_str(&gen->code, "single: var U32 = ");
+	TekBenchGen_literal(gen);
+	TekStk_push_str(&gen->code, "\ndouble_one, double_two: var U32, U32 = ");
+	TekBenchGen_literal(gen);
+	TekStk_push_str(&gen->code, ", ");
+	TekBenchGen_literal(gen);
+	TekStk_push_str(&gen->code, "\n\n");
+
+	for (uint32_t proc_idx = 0; proc_idx < args->procs_per_file; proc_idx += 1) {
+		if (TekBenchGen_chance(gen, args->comment_pct / 4)) {
+			TekStk_push_str(&gen->code, "/*\n");
+			TekBenchGen_comment(gen);
+			TekStk_push_str(&gen->code, "\n*/\n");
+		}
+
+		TekStk_push_str_fmt(&gen->code, "proc_%u: proc(one: U32, two: U32) {\n", proc_idx);
+		for (uint32_t i = 0; i < args->lines_per_proc; i += 1) {
+			TekBenchGen_stmt(gen);
+		}
+		TekStk_push_str(&gen->code, "}\n\n");
+	}
+
+	if (file_idx == 0) {
+		TekStk_push_str(&gen->code, "main: proc() {\n\tproc_0(20, 5)\n}\n");
+	}
+}
+
+//
+// @return: 0 on success, otherwise an errno value.
+static int TekBenchGen_corpus(TekBenchArgs* args, uintptr_t* size_out) {
+	if (mkdir(args->corpus_dir, 0755) != 0 && errno != EEXIST) {
+		return errno;
+	}
+
+	//
+	// the imports need an absolute path, so resolve the directory first.
+	char dir_path[PATH_MAX];
+	if (realpath(args->corpus_dir, dir_path) == NULL) {
+		return errno;
+	}
+	args->corpus_dir = strdup(dir_path);
+
+	TekBenchGen gen = { .args = args, .rng = args->seed ? args->seed : 1 };
+	*size_out = 0;
+	for (uint32_t i = 0; i < args->files_count; i += 1) {
+		TekBenchGen_file(&gen, i);
+
+		char path[PATH_MAX];
+		TekBenchGen_file_path(&gen, i, path);
+		int res = tek_file_write(path, gen.code.TekStk_data, gen.code.count);
+		if (res) return res;
+
+		*size_out += gen.code.count;
+	}
+
+	TekStk_deinit(&gen.code);
+	return 0;
+}
+
+//===========================================================================================
+//
+//
+// benchmark runner
+//
+//
+//===========================================================================================
+
+typedef uint8_t TekBenchMode;
+enum {
+	TekBenchMode_lex,
+	TekBenchMode_syn,
+	TekBenchMode_intern,
+	TekBenchMode_full,
+};
+
+static char* TekBenchMode_strings[] = {
+	[TekBenchMode_lex] = "lex",
+	[TekBenchMode_syn] = "syn",
+	[TekBenchMode_intern] = "intern",
+	[TekBenchMode_full] = "full",
+};
+
+//
+// how the code of each file is loaded before it is lexed in the cold lex runs.
+typedef uint8_t TekBenchLoad;
+enum {
+	// the code is left where the compile put it.
+	TekBenchLoad_none,
+	// read into memory that has not been faulted in yet, the same as a file that fits in the code_buf segment.
+	TekBenchLoad_read,
+	// memory mapped with TekVirtMemMapAdvice_populate.
+	TekBenchLoad_populate,
+	// memory mapped with TekVirtMemMapAdvice_sequential.
+	TekBenchLoad_sequential,
+};
+
+static char* TekBenchLoad_strings[] = {
+	[TekBenchLoad_none] = "none",
+	[TekBenchLoad_read] = "read",
+	[TekBenchLoad_populate] = "populate",
+	[TekBenchLoad_sequential] = "sequential",
+};
+
+typedef struct TekBenchTotals TekBenchTotals;
+struct TekBenchTotals {
+	uint32_t files_count;
+	uint64_t code_size;
+	uint64_t lines_count;
+	uint64_t tokens_count;
+	uint64_t syntax_tree_nodes_count;
+	uint64_t strings_count;
+};
+
+//
+// the identifier and string literal tokens of the project, one after the other, for the intern mode.
+typedef struct TekBenchStrings TekBenchStrings;
+struct TekBenchStrings {
+	TekStk(char) bytes;
+	TekStk(uint32_t) lens;
+};
+
+typedef struct TekBenchStats TekBenchStats;
+struct TekBenchStats {
+	double median_ms;
+	double best_ms;
+	double ci_low_ms;
+	double ci_high_ms;
+};
+
+typedef struct TekBenchResult TekBenchResult;
+struct TekBenchResult {
+	TekBenchMode mode;
+	TekBenchLoad load;
+	uint16_t workers_count;
+	TekBool is_cold;
+	double* samples_ms;
+	TekBenchStats stats;
+};
+
+//
+// the modes that run on the main thread are timed with the CPU time of the thread,
+// so time that the thread spends switched out by other processes on the machine is not counted.
+// the full compiles are timed with the wall clock, as they run on many threads and wait on the disk.
+static double TekBench_now_ms(TekBool is_thread_cpu_time) {
+	struct timespec ts;
+	clock_gettime(is_thread_cpu_time ? CLOCK_THREAD_CPUTIME_ID : CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int TekBench_cmp_double(const void* a, const void* b) {
+	double x = *(double*)a;
+	double y = *(double*)b;
+	return (x > y) - (x < y);
+}
+
+//
+// works out the median of the samples and a 95% confidence interval for it.
+// the interval comes from the order statistics of the sorted samples, so it does not assume the timings
+// follow any distribution. the ranks are n/2 -+ 1.96 * sqrt(n) / 2, from the normal approximation
+// of the number of samples below the median. with fewer than 6 samples this covers all of them.
+static void TekBench_stats(double* samples_ms, uint32_t count, TekBenchStats* stats_out) {
+	double* sorted = tek_alloc_array(double, count);
+	tek_copy_elmts(sorted, samples_ms, count);
+	qsort(sorted, count, sizeof(double), TekBench_cmp_double);
+
+	double half_width = 0.98 * sqrt(count);
+	int64_t low_idx = (int64_t)floor(count / 2.0 - half_width) - 1;
+	int64_t high_idx = (int64_t)ceil(count / 2.0 + 1.0 + half_width) - 1;
+
+	stats_out->best_ms = sorted[0];
+	stats_out->median_ms = count % 2
+		? sorted[count / 2]
+		: (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+	stats_out->ci_low_ms = sorted[tek_clamp(low_idx, 0, (int64_t)count - 1)];
+	stats_out->ci_high_ms = sorted[tek_clamp(high_idx, 0, (int64_t)count - 1)];
+	tek_dealloc_array(sorted, count);
+}
+
+static void TekBench_totals(TekCompiler* c, TekBenchTotals* totals_out) {
+	*totals_out = (TekBenchTotals){0};
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		totals_out->files_count += 1;
+		totals_out->code_size += file->size;
+		totals_out->lines_count += file->lines_count;
+		totals_out->tokens_count += file->tokens_count;
+		totals_out->syntax_tree_nodes_count += file->syntax_tree_nodes_count;
+	}
+}
+
+static void TekBench_compile(TekCompiler* c, uint16_t workers_count, TekCompileArgs* compile_args) {
+	TekCompilerError res = TekCompiler_compile_start(c, workers_count, compile_args);
+	tek_assert(res == TekCompilerError_none, "failed to start the compile '%u'", res);
+	TekCompiler_compile_wait(c);
+
+	if (TekCompiler_has_errors(c)) {
+		TekStk(char) error_string = {0};
+		TekCompiler_errors_string(c, &error_string, tek_true);
+		fprintf(stderr, "%.*s", error_string.count, error_string.TekStk_data);
+		tek_abort("the benchmark corpus failed to compile");
+	}
+}
+
+//
+// loads the code of a file for the cold lex runs, see TekBenchLoad.
+// files are read into @param(read_buf), which must have room for them and should be decommitted between runs.
+static void TekBench_code_load(TekCompiler* c, TekFile* file, TekBenchLoad load, char* read_buf) {
+	char* path = TekStrEntry_value(TekCompiler_strtab_get_entry(c, file->path_str_id));
+	switch (load) {
+		case TekBenchLoad_none:
+			return;
+		case TekBenchLoad_read: {
+			int res = tek_file_read_into(path, read_buf, file->size);
+			tek_assert(res == 0, "failed to read '%s': %s", path, strerror(res));
+			file->code = read_buf;
+			return;
+		}
+		case TekBenchLoad_populate:
+		case TekBenchLoad_sequential: {
+			TekVirtMemMapAdvice advice = load == TekBenchLoad_populate ? TekVirtMemMapAdvice_populate : TekVirtMemMapAdvice_sequential;
+			file->code = tek_virt_mem_map_file(path, TekVirtMemProtection_read, advice, &file->size, &file->handle);
+			tek_assert(file->code, "failed to map '%s': %u", path, tek_virt_mem_get_last_error());
+			file->flags |= TekFileFlags_is_mapped;
+			return;
+		}
+	}
+}
+
+//
+// runs the jobs of the lex and syn modes on the main thread, the same way _TekWorker_main does.
+// the job system is cleared before every file, as the jobs that the lexer queues are not wanted here.
+static void TekBench_run_direct(TekCompiler* c, TekWorker* w, TekBenchMode mode, TekBenchLoad load, char* read_buf) {
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		TekBench_code_load(c, file, load, read_buf);
+		read_buf = tek_ptr_round_up_align(tek_ptr_add(read_buf, file->size), tek_virt_mem_page_size());
+		file->tokens_count = 0;
+		file->token_values_count = 0;
+		file->lines_count = 0;
+		tek_zero_elmt(&c->job_sys);
+		atomic_store(&c->jobs_count, 0);
+
+		TekBool success = TekLexer_lex(&w->lexer, c, file->id);
+		_TekCompiler_file_stage_finish(c, file->id, TekJobType_lex_file);
+
+		if (success && mode == TekBenchMode_syn) {
+			success = TekGenSyn_gen_file(w, file->id);
+			_TekCompiler_file_stage_finish(c, file->id, TekJobType_gen_syn_file);
+		}
+
+		tek_assert(success, "failed to %s '%s'", TekBenchMode_strings[mode], TekStrEntry_value(TekCompiler_strtab_get_entry(c, file->path_str_id)));
+	}
+}
+
+//
+// copies out the identifier and string literal tokens of every file, in the order they were lexed.
+// this walks the token values the same way TekCompiler_debug_tokens does.
+static void TekBench_strings_collect(TekCompiler* c, TekBenchStrings* strings_out) {
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		TekToken* tokens = TekFile_tokens(file);
+		TekValue* token_values = TekFile_token_values(file);
+		uint32_t value_idx = 0;
+		for (uint32_t token_idx = 0; token_idx < file->tokens_count; token_idx += 1) {
+			switch (tokens[token_idx]) {
+				case TekToken_lit_bool:
+				case TekToken_lit_uint:
+				case TekToken_lit_sint:
+				case TekToken_lit_float:
+					value_idx += 1;
+					break;
+				case TekToken_ident:
+				case TekToken_ident_abstract:
+				case TekToken_label:
+				case TekToken_lit_string: {
+					TekStrId str_id = token_values[value_idx].str_id;
+					value_idx += 1;
+					if (str_id == 0) break;
+
+					TekStrEntry entry = TekCompiler_strtab_get_entry(c, str_id);
+					uint32_t len = TekStrEntry_len(entry);
+					TekStk_push_many(&strings_out->bytes, TekStrEntry_value(entry), len);
+					TekStk_push(&strings_out->lens, &len);
+					break;
+				}
+			}
+		}
+	}
+}
+
+//
+// empties the string table of a compiler that is only used for the intern mode.
+// the used part is zeroed instead of making a new compiler, so the timing does not include faulting in the pages.
+static void TekBench_strtab_reset(TekCompiler* c) {
+	uint32_t entries_count = atomic_load(&c->strtab_entries_count);
+	tek_zero_elmts(TekCompiler_strtab_hashes(c), entries_count);
+	tek_zero_elmts(TekCompiler_strtab_entries(c), entries_count);
+	tek_zero_bytes(TekCompiler_strtab_strings(c), atomic_load(&c->strtab_strings_size));
+	atomic_store(&c->strtab_entries_count, 0);
+	atomic_store(&c->strtab_strings_size, 0);
+}
+
+//
+// interns all of the strings into an empty string table.
+static void TekBench_run_intern(TekCompiler* c, TekBenchStrings* strings) {
+	char* str = strings->bytes.TekStk_data;
+	for (uint32_t i = 0; i < strings->lens.count; i += 1) {
+		uint32_t len = strings->lens.TekStk_data[i];
+		TekCompiler_strtab_get_or_insert(c, str, len);
+		str += len;
+	}
+}
+
+//
+// drops the source files from the page cache, so the next compile has to read them from the disk.
+// files that are still mapped from the last compile are unmapped first, or their pages would be kept.
+static void TekBench_page_cache_drop(TekCompiler* c) {
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		if (file->flags & TekFileFlags_is_mapped) {
+			tek_virt_mem_release(file->code, file->size);
+			tek_virt_mem_map_file_close(file->handle);
+			file->flags &= ~TekFileFlags_is_mapped;
+		}
+
+		char* path = TekStrEntry_value(TekCompiler_strtab_get_entry(c, file->path_str_id));
+		int fd = open(path, O_RDONLY);
+		if (fd == -1) continue;
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+}
+
+//
+// @return: the size of the memory that the cold lex runs read the files into, see TekBench_code_load.
+static uintptr_t TekBench_read_buf_size(TekCompiler* c) {
+	uintptr_t page_size = tek_virt_mem_page_size();
+	uintptr_t size = 0;
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		size += (uintptr_t)tek_ptr_round_up_align((void*)files[i].size, page_size);
+	}
+	return tek_max(size, page_size);
+}
+
+static void TekBench_run(TekCompiler* c, TekWorker* w, TekBenchArgs* args, TekCompileArgs* compile_args, TekCompiler* intern_c, TekBenchStrings* strings, char* read_buf, uintptr_t read_buf_size, TekBenchResult* result) {
+	result->samples_ms = tek_alloc_array(double, args->iters);
+	for (uint32_t i = 0; i < args->iters; i += 1) {
+		if (result->is_cold) {
+			TekBench_page_cache_drop(c);
+		}
+
+		if (result->mode == TekBenchMode_intern) {
+			TekBench_strtab_reset(intern_c);
+		}
+
+		//
+		// the code_buf segment of a file is not faulted in when it is taken from the pool,
+		// so the read buffer is not either.
+		if (result->load == TekBenchLoad_read) {
+			tek_virt_mem_decommit(read_buf, read_buf_size);
+		}
+
+		//
+		// the cold runs wait on the disk, which the CPU time of the thread does not count.
+		TekBool is_thread_cpu_time = result->mode != TekBenchMode_full && !result->is_cold;
+		double start_ms = TekBench_now_ms(is_thread_cpu_time);
+		switch (result->mode) {
+			case TekBenchMode_lex:
+			case TekBenchMode_syn:
+				TekBench_run_direct(c, w, result->mode, result->load, read_buf);
+				break;
+			case TekBenchMode_intern:
+				TekBench_run_intern(intern_c, strings);
+				break;
+			case TekBenchMode_full:
+				TekBench_compile(c, result->workers_count, compile_args);
+				break;
+		}
+		result->samples_ms[i] = TekBench_now_ms(is_thread_cpu_time) - start_ms;
+	}
+
+	TekBench_stats(result->samples_ms, args->iters, &result->stats);
+}
+
+//
+// the results are printed with this, so they can be found again when a results file is used as a baseline.
+#define TekBench_result_key_fmt "\"mode\": \"%s\", \"workers\": %u, \"page_cache\": \"%s\""
+
+//
+// finds the result with the same key in a results file written by TekBench_report and reads out its samples.
+// @return: tek_false if the result is not in the file.
+static TekBool TekBench_baseline_samples(char* json, TekBenchResult* result, TekStk(double)* samples_out) {
+	char key[128];
+	snprintf(key, sizeof(key), TekBench_result_key_fmt, TekBenchMode_strings[result->mode], result->workers_count, result->is_cold ? "cold" : "warm");
+	char* pos = strstr(json, key);
+	if (pos == NULL) return tek_false;
+
+	char* samples_key = "\"samples_ms\": [";
+	pos = strstr(pos, samples_key);
+	if (pos == NULL) return tek_false;
+	pos += strlen(samples_key);
+
+	while (1) {
+		char* end = NULL;
+		double sample = strtod(pos, &end);
+		if (end == pos) break;
+		TekStk_push(samples_out, &sample);
+		pos = end;
+		while (*pos == ',' || *pos == ' ') pos += 1;
+	}
+	return samples_out->count != 0;
+}
+
+//
+// @return: the unsigned integer after the key in a results file, or 0 if it is not there.
+static uint64_t TekBench_baseline_uint(char* json, char* key) {
+	char* pos = strstr(json, key);
+	if (pos == NULL) return 0;
+	return strtoull(pos + strlen(key), NULL, 10);
+}
+
+//
+// compares the results to the ones in the baseline results file.
+// a result is a regression when its median is more than gate_pct percent slower than the baseline's
+// and the confidence intervals of the two medians do not overlap.
+// so noise that makes a few runs slow, or a slowdown too small to tell apart from noise, does not fail it.
+// @return: 0 when nothing regressed, 1 when something did and 2 when the baseline could not be used.
+static int TekBench_gate(char* baseline_path, TekBenchArgs* args, TekBenchTotals* totals, TekBenchResult* results, uint32_t results_count) {
+	TekStk(char) json = {0};
+	int res = tek_file_read(baseline_path, &json);
+	if (res) {
+		fprintf(stderr, "failed to read the baseline at '%s': %s\n", baseline_path, strerror(res));
+		return 2;
+	}
+	*TekStk_push(&json, NULL) = '\0';
+
+	//
+	// the byte counts depend on where the corpus was written, as the imports are absolute paths.
+	// so check the corpus is the same with the token and syntax tree node counts instead.
+	uint64_t tokens_count = TekBench_baseline_uint(json.TekStk_data, "\"tokens\": ");
+	uint64_t syntax_tree_nodes_count = TekBench_baseline_uint(json.TekStk_data, "\"syntax_tree_nodes\": ");
+	if (tokens_count != totals->tokens_count || syntax_tree_nodes_count != totals->syntax_tree_nodes_count) {
+		fprintf(stderr,
+			"the baseline at '%s' was recorded with a different corpus (%lu tokens and %lu nodes, this has %lu and %lu).\n"
+			"record a new one with: ./build/tekc_bench --gate --out %s\n",
+			baseline_path, tokens_count, syntax_tree_nodes_count, totals->tokens_count, totals->syntax_tree_nodes_count, baseline_path);
+		return 2;
+	}
+
+	int exit_code = 0;
+	TekStk(double) samples = {0};
+	for (uint32_t i = 0; i < results_count; i += 1) {
+		TekBenchResult* result = &results[i];
+
+		//
+		// the full compiles and cold runs depend too much on the machine's core count and disk to be compared.
+		if (result->mode == TekBenchMode_full || result->is_cold) continue;
+
+		TekStk_clear(&samples);
+		if (!TekBench_baseline_samples(json.TekStk_data, result, &samples)) {
+			fprintf(stderr, "the baseline at '%s' has no %s result\n", baseline_path, TekBenchMode_strings[result->mode]);
+			exit_code = 2;
+			continue;
+		}
+
+		TekBenchStats baseline;
+		TekBench_stats(samples.TekStk_data, samples.count, &baseline);
+		double change_pct = (result->stats.median_ms / baseline.median_ms - 1.0) * 100.0;
+		TekBool is_regression = change_pct > args->gate_pct && result->stats.ci_low_ms > baseline.ci_high_ms;
+		if (is_regression && exit_code == 0) {
+			exit_code = 1;
+		}
+
+		fprintf(stderr, "%-6s %9.3f ms [%.3f, %.3f]  baseline %9.3f ms [%.3f, %.3f]  %+6.1f%%  %s\n",
+			TekBenchMode_strings[result->mode],
+			result->stats.median_ms, result->stats.ci_low_ms, result->stats.ci_high_ms,
+			baseline.median_ms, baseline.ci_low_ms, baseline.ci_high_ms,
+			change_pct, is_regression ? "SLOWER" : "ok");
+	}
+
+	TekStk_deinit(&samples);
+	TekStk_deinit(&json);
+	return exit_code;
+}
+
+//
+// prints a single JSON object with the build config, the corpus and a result for every mode and worker count.
+// the rates are worked out from the median time. speedup and efficiency are against the 1 worker full compile.
+// ci_low_ms and ci_high_ms are the 95% confidence interval of the median, see TekBench_stats.
+static void TekBench_report(TekStk(char)* out, TekBenchArgs* args, TekBenchTotals* totals, TekBenchResult* results, uint32_t results_count) {
+	TekStk_push_str(out, "{\n");
+	TekStk_push_str_fmt(out, "\t\"config\": { \"huge_pages\": %u, \"lexer_simd\": %u, \"lexer_validate_utf8\": %u },\n",
+		TEK_HUGE_PAGES, TEK_LEXER_SIMD, TEK_LEXER_VALIDATE_UTF8);
+	TekStk_push_str_fmt(out,
+		"\t\"corpus\": { \"files\": %u, \"fan_out\": %u, \"procs_per_file\": %u, \"lines_per_proc\": %u, \"idents_per_line\": %u, "
+		"\"literal_pct\": %u, \"float_pct\": %u, \"comment_pct\": %u, \"seed\": %lu, \"bytes\": %lu, \"lines\": %lu, \"tokens\": %lu, \"syntax_tree_nodes\": %lu, \"strings\": %lu },\n",
+		totals->files_count, args->fan_out, args->procs_per_file, args->lines_per_proc, args->idents_per_line,
+		args->literal_pct, args->float_pct, args->comment_pct, args->seed, totals->code_size, totals->lines_count, totals->tokens_count, totals->syntax_tree_nodes_count,
+		totals->strings_count);
+	TekStk_push_str(out, "\t\"results\": [\n");
+
+	double full_one_worker_ms = 0.0;
+	for (uint32_t i = 0; i < results_count; i += 1) {
+		TekBenchResult* result = &results[i];
+		if (result->mode == TekBenchMode_full && result->workers_count == 1 && !result->is_cold) {
+			full_one_worker_ms = result->stats.median_ms;
+		}
+	}
+
+	for (uint32_t i = 0; i < results_count; i += 1) {
+		TekBenchResult* result = &results[i];
+		double secs = result->stats.median_ms / 1e3;
+		TekStk_push_str(out, "\t\t{ ");
+		TekStk_push_str_fmt(out, TekBench_result_key_fmt, TekBenchMode_strings[result->mode], result->workers_count, result->is_cold ? "cold" : "warm");
+		if (result->load) {
+			TekStk_push_str_fmt(out, ", \"load\": \"%s\"", TekBenchLoad_strings[result->load]);
+		}
+		TekStk_push_str_fmt(out, ", \"median_ms\": %.4f, \"ci_low_ms\": %.4f, \"ci_high_ms\": %.4f, \"best_ms\": %.4f, ",
+			result->stats.median_ms, result->stats.ci_low_ms, result->stats.ci_high_ms, result->stats.best_ms);
+		if (result->mode == TekBenchMode_intern) {
+			TekStk_push_str_fmt(out, "\"strings_per_s\": %.0f, ", totals->strings_count / secs);
+		} else {
+			TekStk_push_str_fmt(out, "\"mb_per_s\": %.2f, \"tokens_per_s\": %.0f, ", totals->code_size / 1e6 / secs, totals->tokens_count / secs);
+		}
+		if (result->mode == TekBenchMode_syn || result->mode == TekBenchMode_full) {
+			TekStk_push_str_fmt(out, "\"nodes_per_s\": %.0f, ", totals->syntax_tree_nodes_count / secs);
+		}
+		if (result->mode == TekBenchMode_full && !result->is_cold) {
+			double speedup = full_one_worker_ms / result->stats.median_ms;
+			TekStk_push_str_fmt(out, "\"speedup\": %.3f, \"efficiency\": %.3f, ", speedup, speedup / result->workers_count);
+		}
+
+		TekStk_push_str(out, "\"samples_ms\": [");
+		for (uint32_t j = 0; j < args->iters; j += 1) {
+			TekStk_push_str_fmt(out, j ? ", %.4f" : "%.4f", result->samples_ms[j]);
+		}
+		TekStk_push_str_fmt(out, "] }%s\n", i + 1 < results_count ? "," : "");
+	}
+
+	TekStk_push_str(out, "\t]\n}\n");
+}
+
+//
+// writes the results to @param(out_path), or prints them when it is NULL.
+// @return: tek_false if the results could not be written
+static TekBool TekBench_output(char* out_path, TekStk(char)* out) {
+	if (!out_path) {
+		printf("%.*s", out->count, out->TekStk_data);
+		return tek_true;
+	}
+
+	int res = tek_file_write(out_path, out->TekStk_data, out->count);
+	if (res) {
+		fprintf(stderr, "failed to write the results to '%s': %s\n", out_path, strerror(res));
+		return tek_false;
+	}
+	return tek_true;
+}
+
+#include "bench/containers.c"
+#include "bench/floats.c"
+#include "bench/relex.c"
+
+int main(int argc, char** argv) {
+	char* out_path = NULL;
+	char* baseline_path = NULL;
+	CmdArgerBool gate = cmd_arger_false;
+	int64_t gate_pct = 10;
+	char* corpus_dir = "build/bench_corpus";
+	int64_t files_count = 64;
+	int64_t fan_out = 4;
+	int64_t procs_per_file = 40;
+	int64_t lines_per_proc = 24;
+	int64_t idents_per_line = 3;
+	int64_t literal_pct = 30;
+	int64_t float_pct = 0;
+	int64_t comment_pct = 20;
+	int64_t seed = 1;
+	int64_t iters = 10;
+	int64_t workers_max = 0;
+	CmdArgerBool containers = cmd_arger_false;
+	char* containers_filter = NULL;
+	int64_t containers_ops = 1 << 20;
+	CmdArgerBool floats = cmd_arger_false;
+	int64_t floats_count = 1 << 18;
+	CmdArgerBool relex = cmd_arger_false;
+	int64_t relex_edits = 20000;
+
+	CmdArgerDesc optional_args[] = {
+		cmd_arger_desc_string(&out_path, "out", "path to write the JSON results to, they are printed when this is not set"),
+		cmd_arger_desc_string(&corpus_dir, "corpus_dir", "the directory that the generated project is written to"),
+		cmd_arger_desc_integer(&files_count, "files", "the number of files in the generated project"),
+		cmd_arger_desc_integer(&fan_out, "fan_out", "the number of files that each file imports"),
+		cmd_arger_desc_integer(&procs_per_file, "procs_per_file", "the number of procedures in each file"),
+		cmd_arger_desc_integer(&lines_per_proc, "lines_per_proc", "the number of statements in each procedure"),
+		cmd_arger_desc_integer(&idents_per_line, "idents_per_line", "the number of operands in the expression of each statement, each is an identifier unless it is a literal"),
+		cmd_arger_desc_integer(&literal_pct, "literal_pct", "the chance out of 100 that an operand is a literal instead of an identifier"),
+		cmd_arger_desc_integer(&float_pct, "float_pct", "the chance out of 100 that a literal is a float, with a mix of short, long, tiny and over 19 digit ones. 0 keeps the default mix of literals"),
+		cmd_arger_desc_integer(&comment_pct, "comment_pct", "the chance out of 100 that a statement is followed by a comment"),
+		cmd_arger_desc_integer(&seed, "seed", "the seed of the random number generator used to generate the project"),
+		cmd_arger_desc_integer(&iters, "iters", "the number of times each benchmark is run"),
+		cmd_arger_desc_integer(&workers_max, "workers_max", "the most workers to run the full compile with, 0 is the number of CPUs"),
+		cmd_arger_desc_flag(&gate, "gate", "only run the lex, syn and intern benchmarks, which are the ones compared to a baseline"),
+		cmd_arger_desc_string(&baseline_path, "baseline", "path to the results of an earlier run to compare to, exits with 1 if anything is significantly slower"),
+		cmd_arger_desc_integer(&gate_pct, "gate_pct", "how many percent slower than the baseline a benchmark can be before it fails"),
+		cmd_arger_desc_flag(&containers, "containers", "run the microbenchmarks of the containers in src/util.h instead of compiling a generated project"),
+		cmd_arger_desc_string(&containers_filter, "containers_filter", "only run the container benchmarks where 'container.op' contains this, eg. TekPool.alloc"),
+		cmd_arger_desc_integer(&containers_ops, "containers_ops", "about how many operations each sample of a container benchmark does"),
+		cmd_arger_desc_flag(&floats, "floats", "check the float literal parser against strtod instead of compiling a generated project, exits with 1 if any value is different"),
+		cmd_arger_desc_integer(&floats_count, "floats_count", "the number of random values in each of the random and halfway cases of --floats"),
+		cmd_arger_desc_flag(&relex, "relex", "check TekLexer_relex against TekLexer_lex on the files of the generated project and time the two, exits with 1 if a relex leaves a file different to lexing it from the start"),
+		cmd_arger_desc_integer(&relex_edits, "relex_edits", "about the number of random edits that --relex checks"),
+	};
+
+	char* app_name_and_version = "tek compiler benchmarks";
+	cmd_arger_parse(
+		optional_args, sizeof(optional_args) / sizeof(*optional_args),
+		NULL, 0,
+		argc, argv, app_name_and_version);
+
+	if (workers_max <= 0) {
+		workers_max = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	TekBenchArgs args = {
+		.corpus_dir = corpus_dir,
+		.files_count = tek_max(files_count, 1),
+		.fan_out = tek_max(fan_out, 1),
+		.procs_per_file = tek_max(procs_per_file, 1),
+		.lines_per_proc = tek_max(lines_per_proc, 0),
+		.idents_per_line = tek_max(idents_per_line, 1),
+		.literal_pct = tek_clamp(literal_pct, 0, 100),
+		.float_pct = tek_clamp(float_pct, 0, 100),
+		.comment_pct = tek_clamp(comment_pct, 0, 100),
+		.seed = seed,
+		.iters = tek_max(iters, 1),
+		.workers_max = tek_max(workers_max, 1),
+		.gate_pct = tek_max(gate_pct, 0),
+	};
+
+	if (containers) {
+		TekStk(char) out = {0};
+		TekBenchContainers_run(args.iters, tek_max(containers_ops, 1), args.seed, containers_filter, &out);
+		return TekBench_output(out_path, &out) ? 0 : 1;
+	}
+
+	if (floats) {
+		TekStk(char) out = {0};
+		uint64_t mismatches_count = TekBenchFloats_run(tek_max(floats_count, 1), args.seed, &out);
+		if (!TekBench_output(out_path, &out)) {
+			return 1;
+		}
+		return mismatches_count ? 1 : 0;
+	}
+
+	uintptr_t corpus_size;
+	int res = TekBenchGen_corpus(&args, &corpus_size);
+	if (res) {
+		fprintf(stderr, "failed to generate the benchmark corpus in '%s': %s\n", corpus_dir, strerror(res));
+		return 1;
+	}
+
+	char main_path[PATH_MAX];
+	snprintf(main_path, sizeof(main_path), "%s/main.tek", args.corpus_dir);
+	TekCompileArgs compile_args = { .file_path = main_path };
+
+	//
+	// compile once to find all of the files and to warm up the page cache and the segment pools.
+	TekCompiler* c = TekCompiler_init();
+	TekBench_compile(c, 1, &compile_args);
+	TekBenchTotals totals;
+	TekBench_totals(c, &totals);
+	TekBenchStrings strings = {0};
+	TekBench_strings_collect(c, &strings);
+	totals.strings_count = strings.lens.count;
+	TekCompiler* intern_c = TekCompiler_init();
+
+	static TekWorker w;
+	w.c = c;
+
+	if (relex) {
+		TekStk(char) out = {0};
+		uint64_t mismatches_count = TekBenchRelex_run(c, &w, tek_max(relex_edits, 1), args.iters, args.seed, &out);
+		if (!TekBench_output(out_path, &out)) {
+			return 1;
+		}
+		return mismatches_count ? 1 : 0;
+	}
+
+	uintptr_t read_buf_size = TekBench_read_buf_size(c);
+	char* read_buf = tek_virt_mem_reserve(NULL, read_buf_size, TekVirtMemProtection_read_write);
+	tek_assert(read_buf, "failed to reserve the read buffer '%u'", tek_virt_mem_get_last_error());
+
+	uint32_t results_count = 0;
+	TekBenchResult* results = tek_alloc_array(TekBenchResult, 7 + args.workers_max);
+	results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_lex, .workers_count = 1 };
+	results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_syn, .workers_count = 1 };
+	results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_intern, .workers_count = 1 };
+	if (!gate) {
+		//
+		// these are run after the other direct runs, as they leave the code of the files where they loaded it.
+		for (TekBenchLoad load = TekBenchLoad_read; load <= TekBenchLoad_sequential; load += 1) {
+			results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_lex, .load = load, .workers_count = 1, .is_cold = tek_true };
+		}
+		for (uint32_t workers_count = 1; workers_count <= args.workers_max; workers_count += 1) {
+			results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_full, .workers_count = workers_count };
+		}
+		results[results_count++] = (TekBenchResult){ .mode = TekBenchMode_full, .workers_count = 1, .is_cold = tek_true };
+	}
+
+	for (uint32_t i = 0; i < results_count; i += 1) {
+		TekBench_run(c, &w, &args, &compile_args, intern_c, &strings, read_buf, read_buf_size, &results[i]);
+	}
+
+	TekStk(char) out = {0};
+	TekBench_report(&out, &args, &totals, results, results_count);
+	if (!TekBench_output(out_path, &out)) {
+		return 1;
+	}
+
+	if (baseline_path) {
+		return TekBench_gate(baseline_path, &args, &totals, results, results_count);
+	}
+
+	return 0;
+}
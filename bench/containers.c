@@ -0,0 +1,659 @@
+//
+// microbenchmarks for the containers in src/util.h, run with tekc_bench --containers.
+// build_script.c runs them with --bench and writes the results to build/bench_containers.json.
+// this file is included by bench/bench.c and shares its clock and statistics.
+//
+// every benchmark does an operation once for each of size elements of a container, this is a rep.
+// a sample times enough reps to do about ops_per_sample operations, so the small sizes are not lost in the
+// cost of reading the clock. any setup that is not O(1) happens before the clock is started.
+//
+// the containers are driven through the _Tek functions with the element size as a parameter,
+// which is what the typed macros expand to. each benchmark runs with every type in TekBenchContainers_elmt_types
+// or TekBenchContainers_kv_types, the key value types are an id to id map and the TekStrTab.
+//
+// the quadratic benchmarks move or walk the whole container on every operation,
+// so they only run up to TekBenchContainers_quadratic_size_max elements and do less reps.
+//
+
+//
+// the size of a syntax tree node or a token location, to see how the containers deal with elements bigger than a word.
+typedef struct TekBenchElmt32 TekBenchElmt32;
+struct TekBenchElmt32 {
+	uint64_t a;
+	uint64_t b;
+	uint64_t c;
+	uint64_t d;
+};
+
+typedef struct TekBenchElmtType TekBenchElmtType;
+struct TekBenchElmtType {
+	char* name;
+	uint32_t size;
+	uint32_t align;
+};
+
+typedef struct TekBenchKVType TekBenchKVType;
+struct TekBenchKVType {
+	char* key_name;
+	char* value_name;
+	uint32_t key_size;
+	uint32_t key_align;
+	uint32_t value_size;
+	uint32_t value_align;
+};
+
+static TekBenchElmtType TekBenchContainers_elmt_types[] = {
+	{ "uint32_t", sizeof(uint32_t), alignof(uint32_t) },
+	{ "uint64_t", sizeof(uint64_t), alignof(uint64_t) },
+	{ "TekBenchElmt32", sizeof(TekBenchElmt32), alignof(TekBenchElmt32) },
+};
+
+static TekBenchKVType TekBenchContainers_kv_types[] = {
+	{ "TekStrId", "uint32_t", sizeof(TekStrId), alignof(TekStrId), sizeof(uint32_t), alignof(uint32_t) },
+	{ "TekHash", "TekStrEntry", sizeof(TekHash), alignof(TekHash), sizeof(TekStrEntry), alignof(TekStrEntry) },
+};
+
+static uint32_t TekBenchContainers_sizes[] = { 16, 256, 4096, 65536, 1048576 };
+
+#define TekBenchContainers_quadratic_size_max 4096
+
+//
+// the state that is passed to every benchmark. the random indices and the shuffle are set up for size.
+typedef struct TekBenchContainersCtx TekBenchContainersCtx;
+struct TekBenchContainersCtx {
+	uint32_t size;
+	uint32_t reps;
+	uint32_t elmt_size;
+	uint32_t elmt_align;
+	TekBenchKVType* kv_type;
+	// random numbers in 0..size, one for each operation
+	uint32_t* rand_idxs;
+	// every number in 0..size, in a random order
+	uint32_t* shuffled_idxs;
+	// size elements to push, big enough for any of the types
+	void* elmts;
+	// where popped and removed elements are copied to
+	void* elmt_out;
+	// everything read from the containers is added to this, so the compiler cannot remove the reads
+	uint64_t sink;
+};
+
+typedef double (*TekBenchContainersFn)(TekBenchContainersCtx* ctx);
+
+typedef uint8_t TekBenchContainer;
+enum {
+	TekBenchContainer_stk,
+	TekBenchContainer_deque,
+	TekBenchContainer_pool,
+	TekBenchContainer_kv_stk,
+};
+
+static char* TekBenchContainer_strings[] = {
+	[TekBenchContainer_stk] = "TekStk",
+	[TekBenchContainer_deque] = "TekDeque",
+	[TekBenchContainer_pool] = "TekPool",
+	[TekBenchContainer_kv_stk] = "TekKVStk",
+};
+
+typedef struct TekBenchContainersCase TekBenchContainersCase;
+struct TekBenchContainersCase {
+	TekBenchContainer container;
+	char* op;
+	TekBool is_quadratic;
+	TekBenchContainersFn fn;
+};
+
+static inline uint64_t TekBenchContainers_read(void* elmt) {
+	return *(uint32_t*)elmt;
+}
+
+static inline uint64_t TekBenchContainers_key(TekBenchContainersCtx* ctx, uint32_t idx) {
+	// multiplying by an odd number is a bijection, so every index has a different key that is spread out.
+	uint64_t key = (uint64_t)(idx + 1) * 0x9E3779B97F4A7C15ull;
+	return ctx->kv_type->key_size == sizeof(uint32_t) ? (uint32_t)key : key;
+}
+
+static inline void TekBenchContainers_key_write(TekBenchContainersCtx* ctx, uint32_t idx, void* key_out) {
+	uint64_t key = TekBenchContainers_key(ctx, idx);
+	if (ctx->kv_type->key_size == sizeof(uint32_t)) {
+		*(uint32_t*)key_out = key;
+	} else {
+		*(uint64_t*)key_out = key;
+	}
+}
+
+//===========================================================================================
+//
+//
+// TekStk
+//
+//
+//===========================================================================================
+
+//
+// pushes on to an empty stack, so this includes growing it and freeing it at the end.
+static double TekBenchStk_push(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekStk_push(&stk, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->elmt_size), ctx->elmt_size, ctx->elmt_align);
+		}
+		ctx->sink += TekBenchContainers_read(stk.data);
+		_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+//
+// the same as TekBenchStk_push but 16 elements at a time, like the lexer and the syntax generator push their output.
+static double TekBenchStk_push_many(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 16) {
+			uint32_t count = tek_min(16u, ctx->size - i);
+			_TekStk_push_many(&stk, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->elmt_size), count, ctx->elmt_size, ctx->elmt_align);
+		}
+		ctx->sink += TekBenchContainers_read(stk.data);
+		_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+static double TekBenchStk_pop(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	_TekStk_push_many(&stk, ctx->elmts, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekStk_pop(&stk, ctx->elmt_out, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+		}
+		// popping does not touch the elements, so they are all still there.
+		stk.count = ctx->size;
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+static double TekBenchStk_insert_front(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekStk_insert(&stk, 0, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->elmt_size), ctx->elmt_size, ctx->elmt_align);
+		}
+		ctx->sink += TekBenchContainers_read(stk.data);
+		_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+static double TekBenchStk_swap_remove(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	_TekStk_push_many(&stk, ctx->elmts, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekStk_swap_remove(&stk, ctx->rand_idxs[i] % stk.count, ctx->elmt_out, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+		}
+		// the elements are out of order now, but the benchmark does not care what they are.
+		stk.count = ctx->size;
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+static double TekBenchStk_shift_remove(TekBenchContainersCtx* ctx) {
+	_TekStk stk = {0};
+	_TekStk_push_many(&stk, ctx->elmts, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekStk_shift_remove(&stk, ctx->rand_idxs[i] % stk.count, ctx->elmt_out, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+		}
+		stk.count = ctx->size;
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekStk_deinit(&stk, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+//===========================================================================================
+//
+//
+// TekDeque
+//
+//
+//===========================================================================================
+
+//
+// fills an empty deque and then empties it from the front, so this includes growing it and freeing it at the end.
+static double TekBenchDeque_push_back_pop_front(TekBenchContainersCtx* ctx) {
+	_TekDeque deque = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekDeque_push_back_many(&deque, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->elmt_size), 1, ctx->elmt_size, ctx->elmt_align);
+		}
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekDeque_pop_front_many(&deque, ctx->elmt_out, 1, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+		}
+		_TekDeque_deinit(&deque, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+//
+// the same as TekBenchDeque_push_back_pop_front but it is emptied from the back.
+static double TekBenchDeque_push_back_pop_back(TekBenchContainersCtx* ctx) {
+	_TekDeque deque = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekDeque_push_back_many(&deque, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->elmt_size), 1, ctx->elmt_size, ctx->elmt_align);
+		}
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekDeque_pop_back_many(&deque, ctx->elmt_out, 1, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+		}
+		_TekDeque_deinit(&deque, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+//
+// a queue that always holds size elements, with one pushed on the back for every one popped from the front.
+// the capacity never changes, so the indices wrap around the buffer like the job queue of the compiler.
+static double TekBenchDeque_ring(TekBenchContainersCtx* ctx) {
+	_TekDeque deque = {0};
+	_TekDeque_push_back_many(&deque, ctx->elmts, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekDeque_pop_front_many(&deque, ctx->elmt_out, 1, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(ctx->elmt_out);
+			_TekDeque_push_back_many(&deque, ctx->elmt_out, 1, ctx->elmt_size, ctx->elmt_align);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekDeque_deinit(&deque, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+//===========================================================================================
+//
+//
+// TekPool
+//
+//
+//===========================================================================================
+
+//
+// allocates from an empty pool, so this includes growing it and freeing it at the end.
+static double TekBenchPool_alloc(TekBenchContainersCtx* ctx) {
+	_TekPool pool;
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		_TekPool_init(&pool, 0, ctx->elmt_size, ctx->elmt_align);
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			TekPoolId id;
+			void* elmt = _TekPool_alloc(&pool, &id, ctx->elmt_size, ctx->elmt_align);
+			*(uint32_t*)elmt = i;
+		}
+		ctx->sink += pool.count;
+		_TekPool_deinit(&pool, ctx->elmt_size, ctx->elmt_align);
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+//
+// allocates every element of a pool and then deallocates them with the highest id first.
+// the free list is kept in id order, so every element goes on the front of it.
+static double TekBenchPool_alloc_dealloc_reverse(TekBenchContainersCtx* ctx) {
+	_TekPool pool;
+	_TekPool_init(&pool, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			TekPoolId id;
+			_TekPool_alloc(&pool, &id, ctx->elmt_size, ctx->elmt_align);
+			ctx->sink += id;
+		}
+		for (uint32_t i = ctx->size; i > 0; i -= 1) {
+			_TekPool_dealloc(&pool, i, ctx->elmt_size, ctx->elmt_align);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekPool_deinit(&pool, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+//
+// the same as TekBenchPool_alloc_dealloc_reverse, but with the lowest id first.
+// every element goes on the back of the free list.
+static double TekBenchPool_alloc_dealloc_in_order(TekBenchContainersCtx* ctx) {
+	_TekPool pool;
+	_TekPool_init(&pool, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			TekPoolId id;
+			_TekPool_alloc(&pool, &id, ctx->elmt_size, ctx->elmt_align);
+			ctx->sink += id;
+		}
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekPool_dealloc(&pool, i + 1, ctx->elmt_size, ctx->elmt_align);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekPool_deinit(&pool, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+//
+// the same as TekBenchPool_alloc_dealloc_reverse, but in a random order.
+static double TekBenchPool_alloc_dealloc_random(TekBenchContainersCtx* ctx) {
+	_TekPool pool;
+	_TekPool_init(&pool, ctx->size, ctx->elmt_size, ctx->elmt_align);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			TekPoolId id;
+			_TekPool_alloc(&pool, &id, ctx->elmt_size, ctx->elmt_align);
+			ctx->sink += id;
+		}
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekPool_dealloc(&pool, ctx->shuffled_idxs[i] + 1, ctx->elmt_size, ctx->elmt_align);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekPool_deinit(&pool, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+static double TekBenchPool_id_to_ptr(TekBenchContainersCtx* ctx) {
+	_TekPool pool;
+	_TekPool_init(&pool, ctx->size, ctx->elmt_size, ctx->elmt_align);
+	for (uint32_t i = 0; i < ctx->size; i += 1) {
+		TekPoolId id;
+		void* elmt = _TekPool_alloc(&pool, &id, ctx->elmt_size, ctx->elmt_align);
+		*(uint32_t*)elmt = i;
+	}
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			void* elmt = _TekPool_id_to_ptr(&pool, ctx->rand_idxs[i] + 1, ctx->elmt_size);
+			ctx->sink += TekBenchContainers_read(elmt);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekPool_deinit(&pool, ctx->elmt_size, ctx->elmt_align);
+	return ms;
+}
+
+//===========================================================================================
+//
+//
+// TekKVStk
+//
+//
+//===========================================================================================
+
+#define TekBenchKVStk_sizes(kv_type) (kv_type)->key_size, (kv_type)->key_align, (kv_type)->value_size, (kv_type)->value_align
+
+static void TekBenchKVStk_fill(TekBenchContainersCtx* ctx, _TekKVStk* kv_stk) {
+	uint64_t key;
+	for (uint32_t i = 0; i < ctx->size; i += 1) {
+		TekBenchContainers_key_write(ctx, i, &key);
+		_TekKVStk_push(kv_stk, &key, tek_ptr_add(ctx->elmts, (uintptr_t)i * ctx->kv_type->value_size), TekBenchKVStk_sizes(ctx->kv_type));
+	}
+}
+
+//
+// pushes on to an empty stack, so this includes growing it and freeing it at the end.
+static double TekBenchKVStk_push(TekBenchContainersCtx* ctx) {
+	_TekKVStk kv_stk = {0};
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		TekBenchKVStk_fill(ctx, &kv_stk);
+		ctx->sink += kv_stk.count;
+		_TekKVStk_deinit(&kv_stk, TekBenchKVStk_sizes(ctx->kv_type));
+	}
+	return TekBench_now_ms(tek_true) - start_ms;
+}
+
+//
+// looks up keys that are all in the stack, so on average half of the keys are compared.
+static double TekBenchKVStk_find_key(TekBenchContainersCtx* ctx) {
+	_TekKVStk kv_stk = {0};
+	TekBenchKVStk_fill(ctx, &kv_stk);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			uint64_t key = TekBenchContainers_key(ctx, ctx->rand_idxs[i]);
+			ctx->sink += ctx->kv_type->key_size == sizeof(uint32_t)
+				? _TekKVStk_find_key_32(&kv_stk, 0, kv_stk.count, key, ctx->kv_type->key_size)
+				: _TekKVStk_find_key_64(&kv_stk, 0, kv_stk.count, key, ctx->kv_type->key_size);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekKVStk_deinit(&kv_stk, TekBenchKVStk_sizes(ctx->kv_type));
+	return ms;
+}
+
+static double TekBenchKVStk_get_value(TekBenchContainersCtx* ctx) {
+	_TekKVStk kv_stk = {0};
+	TekBenchKVStk_fill(ctx, &kv_stk);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			void* value = _TekKVStk_get_value(&kv_stk, ctx->rand_idxs[i], TekBenchKVStk_sizes(ctx->kv_type));
+			ctx->sink += TekBenchContainers_read(value);
+		}
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekKVStk_deinit(&kv_stk, TekBenchKVStk_sizes(ctx->kv_type));
+	return ms;
+}
+
+static double TekBenchKVStk_remove_swap(TekBenchContainersCtx* ctx) {
+	_TekKVStk kv_stk = {0};
+	TekBenchKVStk_fill(ctx, &kv_stk);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekKVStk_remove_swap(&kv_stk, ctx->rand_idxs[i] % kv_stk.count, TekBenchKVStk_sizes(ctx->kv_type));
+		}
+		// the keys and values are out of order now, but the benchmark does not care what they are.
+		kv_stk.count = ctx->size;
+		ctx->sink += TekBenchContainers_read(kv_stk.data);
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekKVStk_deinit(&kv_stk, TekBenchKVStk_sizes(ctx->kv_type));
+	return ms;
+}
+
+static double TekBenchKVStk_remove_shift(TekBenchContainersCtx* ctx) {
+	_TekKVStk kv_stk = {0};
+	TekBenchKVStk_fill(ctx, &kv_stk);
+
+	double start_ms = TekBench_now_ms(tek_true);
+	for (uint32_t rep = 0; rep < ctx->reps; rep += 1) {
+		for (uint32_t i = 0; i < ctx->size; i += 1) {
+			_TekKVStk_remove_shift(&kv_stk, ctx->rand_idxs[i] % kv_stk.count, TekBenchKVStk_sizes(ctx->kv_type));
+		}
+		kv_stk.count = ctx->size;
+		ctx->sink += TekBenchContainers_read(kv_stk.data);
+	}
+	double ms = TekBench_now_ms(tek_true) - start_ms;
+
+	_TekKVStk_deinit(&kv_stk, TekBenchKVStk_sizes(ctx->kv_type));
+	return ms;
+}
+
+//===========================================================================================
+//
+//
+// runner
+//
+//
+//===========================================================================================
+
+static TekBenchContainersCase TekBenchContainers_cases[] = {
+	{ TekBenchContainer_stk, "push", tek_false, TekBenchStk_push },
+	{ TekBenchContainer_stk, "push_many", tek_false, TekBenchStk_push_many },
+	{ TekBenchContainer_stk, "pop", tek_false, TekBenchStk_pop },
+	{ TekBenchContainer_stk, "insert_front", tek_true, TekBenchStk_insert_front },
+	{ TekBenchContainer_stk, "swap_remove", tek_false, TekBenchStk_swap_remove },
+	{ TekBenchContainer_stk, "shift_remove", tek_true, TekBenchStk_shift_remove },
+	{ TekBenchContainer_deque, "push_back_pop_front", tek_false, TekBenchDeque_push_back_pop_front },
+	{ TekBenchContainer_deque, "push_back_pop_back", tek_false, TekBenchDeque_push_back_pop_back },
+	{ TekBenchContainer_deque, "ring", tek_false, TekBenchDeque_ring },
+	{ TekBenchContainer_pool, "alloc", tek_false, TekBenchPool_alloc },
+	{ TekBenchContainer_pool, "alloc_dealloc_reverse", tek_false, TekBenchPool_alloc_dealloc_reverse },
+	{ TekBenchContainer_pool, "alloc_dealloc_in_order", tek_true, TekBenchPool_alloc_dealloc_in_order },
+	{ TekBenchContainer_pool, "alloc_dealloc_random", tek_true, TekBenchPool_alloc_dealloc_random },
+	{ TekBenchContainer_pool, "id_to_ptr", tek_false, TekBenchPool_id_to_ptr },
+	{ TekBenchContainer_kv_stk, "push", tek_false, TekBenchKVStk_push },
+	{ TekBenchContainer_kv_stk, "find_key", tek_true, TekBenchKVStk_find_key },
+	{ TekBenchContainer_kv_stk, "get_value", tek_false, TekBenchKVStk_get_value },
+	{ TekBenchContainer_kv_stk, "remove_swap", tek_false, TekBenchKVStk_remove_swap },
+	{ TekBenchContainer_kv_stk, "remove_shift", tek_true, TekBenchKVStk_remove_shift },
+};
+
+//
+// works out how many reps make up a sample. a quadratic operation is counted as size / 16 operations,
+// which is about what it costs to move or compare 16 elements at a time.
+static uint32_t TekBenchContainers_reps(uint32_t size, TekBool is_quadratic, uint32_t ops_per_sample) {
+	uint64_t ops_per_rep = is_quadratic ? tek_max((uint64_t)size * size / 16, size) : size;
+	return tek_max(ops_per_sample / ops_per_rep, 1u);
+}
+
+static void TekBenchContainers_run_case(TekBenchContainersCase* bc, TekBenchContainersCtx* ctx, char* type_name, uint32_t iters, TekStk(char)* out, TekBool* is_first) {
+	double* samples_ms = tek_alloc_array(double, iters);
+	for (uint32_t i = 0; i < iters; i += 1) {
+		samples_ms[i] = bc->fn(ctx);
+	}
+
+	TekBenchStats stats;
+	TekBench_stats(samples_ms, iters, &stats);
+	double ops = (double)ctx->size * ctx->reps;
+
+	TekStk_push_str(out, *is_first ? "\t\t{ " : ",\n\t\t{ ");
+	*is_first = tek_false;
+	TekStk_push_str_fmt(out, "\"container\": \"%s\", \"op\": \"%s\", \"type\": \"%s\", \"size\": %u, \"reps\": %u, ",
+		TekBenchContainer_strings[bc->container], bc->op, type_name, ctx->size, ctx->reps);
+	TekStk_push_str_fmt(out, "\"median_ms\": %.4f, \"ci_low_ms\": %.4f, \"ci_high_ms\": %.4f, \"best_ms\": %.4f, \"ns_per_op\": %.3f, ",
+		stats.median_ms, stats.ci_low_ms, stats.ci_high_ms, stats.best_ms, stats.median_ms * 1e6 / ops);
+	TekStk_push_str(out, "\"samples_ms\": [");
+	for (uint32_t i = 0; i < iters; i += 1) {
+		TekStk_push_str_fmt(out, i ? ", %.4f" : "%.4f", samples_ms[i]);
+	}
+	TekStk_push_str(out, "] }");
+
+	tek_dealloc_array(samples_ms, iters);
+}
+
+//
+// runs every case for every size and type and pushes the JSON results on to @param(out).
+// @param(filter): when not NULL, only the cases where "container.op" contains this string are run.
+static void TekBenchContainers_run(uint32_t iters, uint32_t ops_per_sample, uint64_t seed, char* filter, TekStk(char)* out) {
+	uint32_t sizes_count = sizeof(TekBenchContainers_sizes) / sizeof(*TekBenchContainers_sizes);
+	uint32_t size_max = TekBenchContainers_sizes[sizes_count - 1];
+
+	TekBenchContainersCtx ctx = {0};
+	ctx.rand_idxs = tek_alloc_array(uint32_t, size_max);
+	ctx.shuffled_idxs = tek_alloc_array(uint32_t, size_max);
+	ctx.elmts = tek_alloc_array(TekBenchElmt32, size_max);
+	ctx.elmt_out = tek_alloc_elmt(TekBenchElmt32);
+	for (uint32_t i = 0; i < size_max; i += 1) {
+		((TekBenchElmt32*)ctx.elmts)[i] = (TekBenchElmt32){ .a = i, .b = i, .c = i, .d = i };
+	}
+
+	TekStk_push_str(out, "{\n");
+	TekStk_push_str_fmt(out, "\t\"config\": { \"iters\": %u, \"ops_per_sample\": %u, \"seed\": %lu, \"quadratic_size_max\": %u },\n",
+		iters, ops_per_sample, seed, TekBenchContainers_quadratic_size_max);
+	TekStk_push_str(out, "\t\"results\": [\n");
+
+	TekBool is_first = tek_true;
+	for (uint32_t size_idx = 0; size_idx < sizes_count; size_idx += 1) {
+		uint32_t size = TekBenchContainers_sizes[size_idx];
+		ctx.size = size;
+
+		//
+		// every size gets the same random numbers for the same seed, no matter which cases are run.
+		TekBenchGen gen = { .rng = seed + size };
+		for (uint32_t i = 0; i < size; i += 1) {
+			ctx.rand_idxs[i] = TekBenchGen_range(&gen, size);
+			ctx.shuffled_idxs[i] = i;
+		}
+		for (uint32_t i = size - 1; i > 0; i -= 1) {
+			uint32_t j = TekBenchGen_range(&gen, i + 1);
+			ctx.shuffled_idxs[j] = tek_swap(ctx.shuffled_idxs[i], ctx.shuffled_idxs[j]);
+		}
+
+		for (uint32_t case_idx = 0; case_idx < sizeof(TekBenchContainers_cases) / sizeof(*TekBenchContainers_cases); case_idx += 1) {
+			TekBenchContainersCase* bc = &TekBenchContainers_cases[case_idx];
+			if (bc->is_quadratic && size > TekBenchContainers_quadratic_size_max) continue;
+			if (filter) {
+				char name[128];
+				snprintf(name, sizeof(name), "%s.%s", TekBenchContainer_strings[bc->container], bc->op);
+				if (!strstr(name, filter)) continue;
+			}
+
+			ctx.reps = TekBenchContainers_reps(size, bc->is_quadratic, ops_per_sample);
+			if (bc->container == TekBenchContainer_kv_stk) {
+				for (uint32_t i = 0; i < sizeof(TekBenchContainers_kv_types) / sizeof(*TekBenchContainers_kv_types); i += 1) {
+					TekBenchKVType* kv_type = &TekBenchContainers_kv_types[i];
+					ctx.kv_type = kv_type;
+					char type_name[64];
+					snprintf(type_name, sizeof(type_name), "%s, %s", kv_type->key_name, kv_type->value_name);
+					TekBenchContainers_run_case(bc, &ctx, type_name, iters, out, &is_first);
+				}
+			} else {
+				for (uint32_t i = 0; i < sizeof(TekBenchContainers_elmt_types) / sizeof(*TekBenchContainers_elmt_types); i += 1) {
+					TekBenchElmtType* elmt_type = &TekBenchContainers_elmt_types[i];
+					ctx.elmt_size = elmt_type->size;
+					ctx.elmt_align = elmt_type->align;
+					TekBenchContainers_run_case(bc, &ctx, elmt_type->name, iters, out, &is_first);
+				}
+			}
+		}
+	}
+
+	TekStk_push_str_fmt(out, "\n\t],\n\t\"sink\": %lu\n}\n", ctx.sink);
+
+	tek_dealloc_array(ctx.rand_idxs, size_max);
+	tek_dealloc_array(ctx.shuffled_idxs, size_max);
+	tek_dealloc_array((TekBenchElmt32*)ctx.elmts, size_max);
+	tek_dealloc_elmt((TekBenchElmt32*)ctx.elmt_out);
+}
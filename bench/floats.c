@@ -0,0 +1,233 @@
+//
+// a differential check of the float literal parser against strtod, run with tekc_bench --floats.
+// build_script.c runs it with --bench_gate, and it fails when any value is not the same double that strtod gives.
+// this file is included by bench/bench.c and uses its random number generator.
+//
+// every case is checked twice. once as a float literal through _TekLexer_parse_float,
+// and once with the mantissa and power of ten given straight to _TekLexer_eisel_lemire.
+// when either of them cannot work out the value, the lexer falls back to strtod, so that is not a mismatch.
+//
+// the cases are:
+//     random  - literals with 1 to 30 random digits, the decimal point anywhere and extra zeros at either end.
+//     edge    - the mantissas at the edges of what a double and a uint64_t can hold, with every power of ten
+//               in the Eisel-Lemire table.
+//     halfway - values that are exactly halfway between two doubles, and the closest 19 digit values either side
+//               of the halfway point of random doubles.
+//
+
+typedef uint8_t TekBenchFloatsCase;
+enum {
+	TekBenchFloatsCase_random,
+	TekBenchFloatsCase_edge,
+	TekBenchFloatsCase_halfway,
+	TekBenchFloatsCase_COUNT,
+};
+
+static char* TekBenchFloatsCase_strings[] = {
+	[TekBenchFloatsCase_random] = "random",
+	[TekBenchFloatsCase_edge] = "edge",
+	[TekBenchFloatsCase_halfway] = "halfway",
+};
+
+typedef struct TekBenchFloatsCounts TekBenchFloatsCounts;
+struct TekBenchFloatsCounts {
+	uint64_t literals_count;
+	uint64_t literals_fallback_count;
+	uint64_t eisel_lemire_count;
+	uint64_t eisel_lemire_fallback_count;
+	uint64_t mismatches_count;
+};
+
+//
+// the longest literal that is checked, the lexer's number buffer is 128 bytes.
+#define TekBenchFloats_literal_cap 120
+
+static TekBool TekBenchFloats_same(double a, double b) {
+	return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+//
+// checks a float literal, this must have a single decimal point and may start with a minus sign.
+static void TekBenchFloats_check_literal(char* literal, TekBenchFloatsCounts* counts) {
+	counts->literals_count += 1;
+
+	double value;
+	if (!_TekLexer_parse_float(literal, strlen(literal), &value)) {
+		counts->literals_fallback_count += 1;
+		return;
+	}
+
+	double expected = strtod(literal, NULL);
+	if (!TekBenchFloats_same(value, expected)) {
+		counts->mismatches_count += 1;
+		fprintf(stderr, "_TekLexer_parse_float(\"%s\") = %.17g, strtod gives %.17g\n", literal, value, expected);
+	}
+}
+
+//
+// checks the value @param(mantissa) * 10^@param(exp10) with _TekLexer_eisel_lemire,
+// and as a literal when it is short enough to write out.
+static void TekBenchFloats_check(uint64_t mantissa, int32_t exp10, TekBool is_negative, TekBenchFloatsCounts* counts) {
+	char digits[32];
+	uint32_t digits_count = snprintf(digits, sizeof(digits), "%lu", mantissa);
+
+	char scientific[64];
+	snprintf(scientific, sizeof(scientific), "%s%se%d", is_negative ? "-" : "", digits, exp10);
+	double expected = strtod(scientific, NULL);
+
+	if (mantissa) {
+		counts->eisel_lemire_count += 1;
+		double value;
+		if (!_TekLexer_eisel_lemire(mantissa, exp10, is_negative, &value)) {
+			counts->eisel_lemire_fallback_count += 1;
+		} else if (!TekBenchFloats_same(value, expected)) {
+			counts->mismatches_count += 1;
+			fprintf(stderr, "_TekLexer_eisel_lemire(%s) = %.17g, strtod gives %.17g\n", scientific, value, expected);
+		}
+	}
+
+	//
+	// write it out with the decimal point, the only way a float literal can be written.
+	uint32_t abs_exp10 = exp10 < 0 ? -exp10 : exp10;
+	if (digits_count + abs_exp10 + 3 > TekBenchFloats_literal_cap) {
+		return;
+	}
+
+	char literal[TekBenchFloats_literal_cap + 8];
+	uint32_t len = 0;
+	if (is_negative) literal[len++] = '-';
+	if (exp10 >= 0) {
+		len += sprintf(&literal[len], "%s", digits);
+		for (uint32_t i = 0; i < abs_exp10; i += 1) literal[len++] = '0';
+		len += sprintf(&literal[len], ".0");
+	} else if (abs_exp10 < digits_count) {
+		uint32_t int_count = digits_count - abs_exp10;
+		len += sprintf(&literal[len], "%.*s.%s", int_count, digits, &digits[int_count]);
+	} else {
+		len += sprintf(&literal[len], "0.");
+		for (uint32_t i = digits_count; i < abs_exp10; i += 1) literal[len++] = '0';
+		len += sprintf(&literal[len], "%s", digits);
+	}
+	TekBenchFloats_check_literal(literal, counts);
+}
+
+static uint64_t TekBenchFloats_rand_u64(TekBenchGen* gen) {
+	return ((uint64_t)TekBenchGen_rand(gen) << 32) | TekBenchGen_rand(gen);
+}
+
+static void TekBenchFloats_case_random(TekBenchGen* gen, uint32_t count, TekBenchFloatsCounts* counts) {
+	for (uint32_t i = 0; i < count; i += 1) {
+		char literal[TekBenchFloats_literal_cap + 8];
+		uint32_t len = 0;
+		if (TekBenchGen_chance(gen, 50)) literal[len++] = '-';
+
+		uint32_t leading_zeros_count = TekBenchGen_chance(gen, 30) ? TekBenchGen_range(gen, 40) : 0;
+		uint32_t digits_count = 1 + TekBenchGen_range(gen, 30);
+		uint32_t trailing_zeros_count = TekBenchGen_chance(gen, 30) ? TekBenchGen_range(gen, 40) : 0;
+		uint32_t total_count = leading_zeros_count + digits_count + trailing_zeros_count;
+		uint32_t point_idx = 1 + TekBenchGen_range(gen, total_count);
+
+		for (uint32_t j = 0; j < total_count; j += 1) {
+			if (j == point_idx) literal[len++] = '.';
+			TekBool is_zero = j < leading_zeros_count || j >= leading_zeros_count + digits_count;
+			literal[len++] = is_zero ? '0' : '0' + TekBenchGen_range(gen, 10);
+		}
+		if (point_idx == total_count) {
+			literal[len++] = '.';
+			literal[len++] = '0';
+		}
+		literal[len] = '\0';
+
+		TekBenchFloats_check_literal(literal, counts);
+	}
+}
+
+static void TekBenchFloats_case_edge(TekBenchGen* gen, TekBenchFloatsCounts* counts) {
+	uint64_t mantissas[] = {
+		1, 2, 9, 10,
+		(1ull << 53) - 1, 1ull << 53, (1ull << 53) + 1, (1ull << 54) - 1, 1ull << 54,
+		1000000000000000000ull, 9999999999999999999ull,
+		UINT64_MAX, 0,
+	};
+
+	uint32_t mantissas_count = sizeof(mantissas) / sizeof(*mantissas);
+	for (int32_t exp10 = TekLexerPow10_min_exp10 - 2; exp10 <= TekLexerPow10_max_exp10 + 2; exp10 += 1) {
+		//
+		// the last mantissa is a random one.
+		mantissas[mantissas_count - 1] = TekBenchFloats_rand_u64(gen);
+		for (uint32_t i = 0; i < mantissas_count; i += 1) {
+			TekBenchFloats_check(mantissas[i], exp10, TekBenchGen_chance(gen, 50), counts);
+		}
+	}
+}
+
+static void TekBenchFloats_case_halfway(TekBenchGen* gen, uint32_t count, TekBenchFloatsCounts* counts) {
+	for (uint32_t i = 0; i < count; i += 1) {
+		TekBool is_negative = TekBenchGen_chance(gen, 50);
+
+		//
+		// an odd integer between 2^53 and 2^54 is exactly halfway between the two even integers either side of it,
+		// which are doubles. moving it up by a power of two or down by a few powers of ten keeps it halfway.
+		uint64_t halfway = (1ull << 53) | TekBenchFloats_rand_u64(gen) | 1;
+		halfway &= (1ull << 54) - 1;
+		TekBenchFloats_check(halfway << TekBenchGen_range(gen, 10), 0, is_negative, counts);
+
+		uint32_t shift = TekBenchGen_range(gen, 4);
+		uint64_t pow5 = 1;
+		for (uint32_t j = 0; j < shift; j += 1) pow5 *= 5;
+		TekBenchFloats_check(halfway * pow5, -(int32_t)shift, is_negative, counts);
+
+		//
+		// the halfway point of a random normal double, worked out exactly in a long double.
+		// 19 significant digits cannot write most of these exactly, so check the closest value on each side.
+		// the largest double is left out, as there is no double after it.
+		uint64_t biased_exp2 = 1 + TekBenchGen_range(gen, 0x7fe);
+		uint64_t bits = (biased_exp2 << 52) | (TekBenchFloats_rand_u64(gen) & 0x000fffffffffffffull);
+		bits -= bits == 0x7fefffffffffffffull;
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		long double midpoint = ((long double)value + (long double)nextafter(value, INFINITY)) / 2;
+
+		char scientific[64];
+		snprintf(scientific, sizeof(scientific), "%.18Le", midpoint);
+		uint64_t mantissa = 0;
+		for (char* c = scientific; *c != 'e'; c += 1) {
+			if (*c != '.') mantissa = mantissa * 10 + (*c - '0');
+		}
+		int32_t exp10 = atoi(strchr(scientific, 'e') + 1) - 18;
+		for (int32_t delta = -1; delta <= 1; delta += 1) {
+			TekBenchFloats_check(mantissa + delta, exp10, is_negative, counts);
+		}
+	}
+}
+
+//
+// runs every case and pushes the JSON results on to @param(out).
+// @param(count): the number of random values in each of the random and halfway cases.
+// @return: the number of values that were not the same as strtod.
+static uint64_t TekBenchFloats_run(uint32_t count, uint64_t seed, TekStk(char)* out) {
+	TekStk_push_str(out, "{\n");
+	TekStk_push_str_fmt(out, "\t\"config\": { \"count\": %u, \"seed\": %lu },\n", count, seed);
+	TekStk_push_str(out, "\t\"results\": [\n");
+
+	uint64_t mismatches_count = 0;
+	for (TekBenchFloatsCase bc = 0; bc < TekBenchFloatsCase_COUNT; bc += 1) {
+		TekBenchGen gen = { .rng = seed + bc };
+		TekBenchFloatsCounts counts = {0};
+		switch (bc) {
+			case TekBenchFloatsCase_random: TekBenchFloats_case_random(&gen, count, &counts); break;
+			case TekBenchFloatsCase_edge: TekBenchFloats_case_edge(&gen, &counts); break;
+			case TekBenchFloatsCase_halfway: TekBenchFloats_case_halfway(&gen, count, &counts); break;
+		}
+		mismatches_count += counts.mismatches_count;
+
+		TekStk_push_str_fmt(out,
+			"\t\t{ \"case\": \"%s\", \"literals\": %lu, \"literals_fallback\": %lu, \"eisel_lemire\": %lu, \"eisel_lemire_fallback\": %lu, \"mismatches\": %lu }%s\n",
+			TekBenchFloatsCase_strings[bc], counts.literals_count, counts.literals_fallback_count,
+			counts.eisel_lemire_count, counts.eisel_lemire_fallback_count, counts.mismatches_count,
+			bc + 1 < TekBenchFloatsCase_COUNT ? "," : "");
+	}
+
+	TekStk_push_str(out, "\t]\n}\n");
+	return mismatches_count;
+}
@@ -0,0 +1,572 @@
+//
+// a differential check of TekLexer_relex against TekLexer_lex and a benchmark of the two, run with tekc_bench --relex.
+// build_script.c runs it with --bench_gate, and it fails when a relex leaves a file different to lexing it from the start
+// or relexes more of the file than the edit needs.
+// this file is included by bench/bench.c and runs on the files of the generated project once they have been compiled.
+//
+// the check makes runs of random edits to random files. each edit deletes up to 8 bytes and inserts one of:
+//     copy    - up to 16 bytes copied from somewhere else in the file.
+//     snippet - one of TekBenchRelex_snippets, these open and close strings, block comments and brackets.
+//     chars   - 1 to 3 random characters out of TekBenchRelex_chars.
+//     short   - a space, a newline, a letter, a digit and such, with nothing deleted.
+// most of the edits that leave a lex error are undone straight after, so a run stacks up edits on a file that still lexes.
+// at the end of a run the whole file is replaced with the code it started with.
+//
+// after every edit the tokens, token locations, values, line starts and bracket matches are copied out,
+// and the file is lexed again from the start with TekLexer_lex. these must all be the same, and so must the error,
+// if there is one. every bracket match must also pair up an open and a close bracket of the same kind.
+// the relexed copy is then put back, with the shift that TekLexer_relex left on the locations,
+// so that the next edit is made on top of it.
+//
+// the span check types TekBenchRelex_typed into every file that TekLexer_relex can edit and inserts spaces at random places,
+// deleting it all again after. each of these edits only changes the tokens next to it, so one that relexes more than
+// TekBenchRelex_span_tokens_max tokens fails the check, as it is doing work that grows with the size of the file.
+// the edits made while the file has a lex error are not counted, as the next edit after an error lexes the rest of the file.
+//
+// the benchmark runs on the largest file that TekLexer_relex can edit, each sample is the mean of a batch of edits:
+//     typing - types out TekBenchRelex_typed at the start of a line one character at a time and then deletes it again.
+//     random - inserts a space at a random place and then deletes it again. the tokens and lines between
+//              one edit and the next have their shift moved, so this costs more the further apart the edits are.
+//     full   - TekLexer_lex of the whole file.
+//
+
+typedef uint8_t TekBenchRelexCase;
+enum {
+	TekBenchRelexCase_typing,
+	TekBenchRelexCase_random,
+	TekBenchRelexCase_full,
+	TekBenchRelexCase_COUNT,
+};
+
+static char* TekBenchRelexCase_strings[] = {
+	[TekBenchRelexCase_typing] = "typing",
+	[TekBenchRelexCase_random] = "random",
+	[TekBenchRelexCase_full] = "full",
+};
+
+static char* TekBenchRelex_snippets[] = {
+	"\"", "\"\"\"\n", "'", "{", "}", "(", ")", "[", "]", "/*", "*/", "//", "\n", "\r\n",
+	"0x", "1.5", "1e10", "$", "#", "..", "-", ";", " ", "\t", "abc", "\xc3\xa9", "\xff",
+};
+
+static char* TekBenchRelex_shorts[] = { " ", "\n", "a", "1", "\t", "\n\n", "x_", "\xc3\xa9" };
+
+static char TekBenchRelex_chars[] = "az09_ ({})\n\"'./*";
+
+static char TekBenchRelex_typed[] = "\tvalue := value + 12 // typed\n";
+
+//
+// the number of edits in each sample of the random case.
+#define TekBenchRelex_random_edits_count 64
+
+//
+// the most tokens that one edit of the span check may relex.
+// those edits only change the tokens right next to them, so relexing more than this means the relex does work that grows with the file.
+#define TekBenchRelex_span_tokens_max 64
+
+typedef struct TekBenchRelexCounts TekBenchRelexCounts;
+struct TekBenchRelexCounts {
+	uint64_t edits_count;
+	uint64_t ok_count;
+	uint64_t error_count;
+	uint64_t no_room_count;
+	uint64_t synced_count;
+	uint64_t relexed_tokens_count;
+	uint64_t mismatches_count;
+};
+
+//
+// what the edits of TekBenchRelex_span_check relexed.
+typedef struct TekBenchRelexSpanCounts TekBenchRelexSpanCounts;
+struct TekBenchRelexSpanCounts {
+	uint64_t files_count;
+	uint64_t largest_file_size;
+	uint64_t edits_count;
+	uint64_t relexed_tokens_count;
+	uint64_t relexed_tokens_max;
+	uint64_t relexed_tokens_max_file_size;
+	uint64_t over_count;
+};
+
+typedef_TekStk(TekToken);
+typedef_TekStk(TekTokenLocCompact);
+typedef_TekStk(uintptr_t);
+
+//
+// a copy of the lexed state of a file, as TekLexer_relex left it.
+typedef struct TekBenchRelexCopy TekBenchRelexCopy;
+struct TekBenchRelexCopy {
+	TekStk(TekToken) tokens;
+	TekStk(TekTokenLocCompact) token_locs;
+	TekStk(TekValue) token_values;
+	TekStk(uint32_t) bracket_matches;
+	TekStk(uintptr_t) line_code_start_indices;
+	//
+	// the token locations and line starts with the shift added on, to compare to a full lex.
+	TekStk(TekTokenLocCompact) real_token_locs;
+	TekStk(uintptr_t) real_line_code_start_indices;
+	uint32_t relex_token_idx;
+	uint32_t relex_line_idx;
+	uint32_t relex_values_count;
+	uint32_t relex_code_idx_shift;
+	TekFileFlags flags;
+};
+
+static void TekBenchRelexCopy_save(TekBenchRelexCopy* copy, TekFile* file) {
+	TekStk_clear(&copy->tokens);
+	TekStk_clear(&copy->token_locs);
+	TekStk_clear(&copy->token_values);
+	TekStk_clear(&copy->bracket_matches);
+	TekStk_clear(&copy->line_code_start_indices);
+	TekStk_clear(&copy->real_token_locs);
+	TekStk_clear(&copy->real_line_code_start_indices);
+
+	TekStk_push_many(&copy->tokens, TekFile_tokens(file), file->tokens_count);
+	TekStk_push_many(&copy->token_locs, _TekFile_token_locs(file), file->tokens_count);
+	TekStk_push_many(&copy->token_values, TekFile_token_values(file), file->token_values_count);
+	TekStk_push_many(&copy->bracket_matches, TekFile_bracket_matches(file), file->tokens_count);
+	TekStk_push_many(&copy->line_code_start_indices, _TekFile_line_code_start_indices(file), file->lines_count);
+	for (uint32_t i = 0; i < file->tokens_count; i += 1) {
+		*TekStk_push(&copy->real_token_locs, NULL) = TekFile_token_loc_compact(file, i);
+	}
+	for (uint32_t i = 0; i < file->lines_count; i += 1) {
+		*TekStk_push(&copy->real_line_code_start_indices, NULL) = TekFile_line_code_start_idx(file, i);
+	}
+
+	copy->relex_token_idx = file->relex_token_idx;
+	copy->relex_line_idx = file->relex_line_idx;
+	copy->relex_values_count = file->relex_values_count;
+	copy->relex_code_idx_shift = file->relex_code_idx_shift;
+	copy->flags = file->flags;
+}
+
+//
+// puts the copy back over what TekLexer_lex left in the file,
+// and zeroes what it wrote past the end of the copy, as TekLexer_relex expects the unused memory to be zero.
+static void TekBenchRelexCopy_restore(TekBenchRelexCopy* copy, TekFile* file) {
+	uint32_t tokens_count = copy->tokens.count;
+	uint32_t token_values_count = copy->token_values.count;
+	uint32_t lines_count = copy->line_code_start_indices.count;
+	tek_copy_elmts(TekFile_tokens(file), copy->tokens.TekStk_data, tokens_count);
+	tek_copy_elmts(_TekFile_token_locs(file), copy->token_locs.TekStk_data, tokens_count);
+	tek_copy_elmts(TekFile_token_values(file), copy->token_values.TekStk_data, token_values_count);
+	tek_copy_elmts(TekFile_bracket_matches(file), copy->bracket_matches.TekStk_data, tokens_count);
+	tek_copy_elmts(_TekFile_line_code_start_indices(file), copy->line_code_start_indices.TekStk_data, lines_count);
+
+	if (file->tokens_count > tokens_count) {
+		uint32_t count = file->tokens_count - tokens_count;
+		tek_zero_elmts(&TekFile_tokens(file)[tokens_count], count);
+		tek_zero_elmts(&_TekFile_token_locs(file)[tokens_count], count);
+		tek_zero_elmts(&TekFile_bracket_matches(file)[tokens_count], count);
+	}
+	if (file->token_values_count > token_values_count) {
+		uint32_t count = file->token_values_count - token_values_count;
+		tek_zero_elmts(&TekFile_token_values(file)[token_values_count], count);
+	}
+	if (file->lines_count > lines_count) {
+		uint32_t count = file->lines_count - lines_count;
+		tek_zero_elmts(&_TekFile_line_code_start_indices(file)[lines_count], count);
+	}
+
+	file->tokens_count = tokens_count;
+	file->token_values_count = token_values_count;
+	file->lines_count = lines_count;
+	file->relex_token_idx = copy->relex_token_idx;
+	file->relex_line_idx = copy->relex_line_idx;
+	file->relex_values_count = copy->relex_values_count;
+	file->relex_code_idx_shift = copy->relex_code_idx_shift;
+	file->flags = copy->flags;
+}
+
+static void TekBenchRelexCopy_deinit(TekBenchRelexCopy* copy) {
+	TekStk_deinit(&copy->tokens);
+	TekStk_deinit(&copy->token_locs);
+	TekStk_deinit(&copy->token_values);
+	TekStk_deinit(&copy->bracket_matches);
+	TekStk_deinit(&copy->line_code_start_indices);
+	TekStk_deinit(&copy->real_token_locs);
+	TekStk_deinit(&copy->real_line_code_start_indices);
+}
+
+//
+// @return: the first index where @param(a) and @param(b) are not the same, or @param(count) if they are.
+static uint32_t TekBenchRelex_diff_idx(void* a, void* b, uint32_t count, uint32_t elmt_size) {
+	for (uint32_t i = 0; i < count; i += 1) {
+		if (memcmp(tek_ptr_add(a, i * elmt_size), tek_ptr_add(b, i * elmt_size), elmt_size) != 0) {
+			return i;
+		}
+	}
+	return count;
+}
+
+//
+// checks that every pair in the bracket_matches of @param(file) has an open and a close bracket of the same kind on its ends,
+// and that every other token has no match.
+// @return: the first token that is not paired up right, or the tokens count if they all are.
+static uint32_t TekBenchRelex_bracket_pairs_check(TekFile* file) {
+	TekToken* tokens = TekFile_tokens(file);
+	for (uint32_t idx = 0; idx < file->tokens_count; idx += 1) {
+		TekToken close_token;
+		switch (tokens[idx]) {
+			case '(': close_token = ')'; break;
+			case '{': close_token = '}'; break;
+			case '[': close_token = ']'; break;
+			case ')':
+			case '}':
+			case ']':
+				if (TekFile_bracket_close_idx(file, TekFile_bracket_open_idx(file, idx)) != idx) return idx;
+				continue;
+			default:
+				if (TekFile_bracket_matches(file)[idx] != 0) return idx;
+				continue;
+		}
+
+		uint32_t close_idx = TekFile_bracket_close_idx(file, idx);
+		if (close_idx && (close_idx >= file->tokens_count || tokens[close_idx] != close_token)) return idx;
+	}
+	return file->tokens_count;
+}
+
+static void TekBenchRelex_mismatch(TekFile* file, TekLexerEdit* edit, char* what, uint32_t idx, TekBenchRelexCounts* counts) {
+	counts->mismatches_count += 1;
+	fprintf(stderr, "TekLexer_relex of file %u at %u deleting %u inserting \"%.*s\" left %s %u different to TekLexer_lex\n",
+		file->id, edit->code_idx, edit->deleted_len, edit->inserted_len, edit->inserted, what, idx);
+}
+
+//
+// makes @param(edit) with TekLexer_relex and then checks it against lexing the file from the start.
+// the file is left as TekLexer_relex left it.
+static TekLexerRelexResult TekBenchRelex_check_edit(TekCompiler* c, TekWorker* w, TekFile* file, TekLexerEdit* edit, TekBenchRelexCopy* copy, TekBenchRelexCounts* counts) {
+	uint32_t errors_count = atomic_load(&c->errors_count);
+	TekLexerRelexSpan span;
+	TekLexerRelexResult res = TekLexer_relex(&w->lexer, c, file->id, edit, &span);
+
+	counts->edits_count += 1;
+	if (res == TekLexerRelexResult_no_room) {
+		counts->no_room_count += 1;
+		return res;
+	}
+	counts->relexed_tokens_count += span.added_count;
+	counts->synced_count += span.token_idx + span.added_count < file->tokens_count;
+
+	uint32_t relex_errors_count = atomic_load(&c->errors_count);
+	TekError relex_error = relex_errors_count > errors_count ? TekCompiler_errors(c)[errors_count] : (TekError){0};
+	TekBenchRelexCopy_save(copy, file);
+
+	file->tokens_count = 0;
+	file->token_values_count = 0;
+	file->lines_count = 0;
+	TekBool success = TekLexer_lex(&w->lexer, c, file->id);
+	tek_zero_elmt(&c->job_sys);
+	atomic_store(&c->jobs_count, 0);
+
+	uint32_t lex_errors_count = atomic_load(&c->errors_count);
+	TekError lex_error = lex_errors_count > relex_errors_count ? TekCompiler_errors(c)[relex_errors_count] : (TekError){0};
+	atomic_store(&c->errors_count, errors_count);
+
+	if (!success) {
+		counts->error_count += 1;
+	}
+	if (success != (res == TekLexerRelexResult_ok) || relex_error.kind != lex_error.kind) {
+		TekBenchRelex_mismatch(file, edit, "the error kind", relex_error.kind, counts);
+	} else if (!success) {
+		//
+		// an invalid utf8 error is found by validating the code before it is lexed,
+		// and the relex only validates what it lexes, so the token it points to can be different.
+		if (lex_error.kind != TekErrorKind_lexer_invalid_utf8 && relex_error.args[0].token_idx != lex_error.args[0].token_idx) {
+			TekBenchRelex_mismatch(file, edit, "the error at token", relex_error.args[0].token_idx, counts);
+		}
+	} else {
+		//
+		// TekLexer_lex leaves no shift on the file, so its locations and line starts can be compared as they are stored.
+		tek_assert(file->relex_code_idx_shift == 0, "TekLexer_lex left a shift of '%d' on the locations of file %u", (int32_t)file->relex_code_idx_shift, file->id);
+		counts->ok_count += 1;
+		uint32_t idx;
+		if (copy->tokens.count != file->tokens_count) {
+			TekBenchRelex_mismatch(file, edit, "the tokens count", copy->tokens.count, counts);
+		} else if (copy->token_values.count != file->token_values_count) {
+			TekBenchRelex_mismatch(file, edit, "the token values count", copy->token_values.count, counts);
+		} else if (copy->line_code_start_indices.count != file->lines_count) {
+			TekBenchRelex_mismatch(file, edit, "the lines count", copy->line_code_start_indices.count, counts);
+		} else if ((idx = TekBenchRelex_diff_idx(copy->tokens.TekStk_data, TekFile_tokens(file), file->tokens_count, sizeof(TekToken))) < file->tokens_count) {
+			TekBenchRelex_mismatch(file, edit, "token", idx, counts);
+		} else if ((idx = TekBenchRelex_diff_idx(copy->real_token_locs.TekStk_data, _TekFile_token_locs(file), file->tokens_count, sizeof(TekTokenLocCompact))) < file->tokens_count) {
+			TekBenchRelex_mismatch(file, edit, "the location of token", idx, counts);
+		} else if ((idx = TekBenchRelex_diff_idx(copy->bracket_matches.TekStk_data, TekFile_bracket_matches(file), file->tokens_count, sizeof(uint32_t))) < file->tokens_count) {
+			TekBenchRelex_mismatch(file, edit, "the bracket match of token", idx, counts);
+		} else if ((idx = TekBenchRelex_bracket_pairs_check(file)) < file->tokens_count) {
+			TekBenchRelex_mismatch(file, edit, "the bracket pair of token", idx, counts);
+		} else if ((idx = TekBenchRelex_diff_idx(copy->token_values.TekStk_data, TekFile_token_values(file), file->token_values_count, sizeof(TekValue))) < file->token_values_count) {
+			TekBenchRelex_mismatch(file, edit, "token value", idx, counts);
+		} else if ((idx = TekBenchRelex_diff_idx(copy->real_line_code_start_indices.TekStk_data, _TekFile_line_code_start_indices(file), file->lines_count, sizeof(uintptr_t))) < file->lines_count) {
+			TekBenchRelex_mismatch(file, edit, "the start of line", idx, counts);
+		}
+	}
+
+	TekBenchRelexCopy_restore(copy, file);
+	return res;
+}
+
+//
+// makes @param(edits_count) runs of 1 to 20 random edits to random files of the project, see the top of this file.
+static void TekBenchRelex_check(TekCompiler* c, TekWorker* w, uint32_t edits_count, uint64_t seed, TekBenchRelexCounts* counts) {
+	TekBenchGen gen = { .rng = seed };
+	TekBenchRelexCopy copy = {0};
+	TekStk(char) original_code = {0};
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	char inserted[32];
+	char deleted[16];
+	while (counts->edits_count < edits_count) {
+		TekFile* file = &files[TekBenchGen_range(&gen, files_count)];
+		uint32_t run_edits_count = 1 + TekBenchGen_range(&gen, 20);
+		TekStk_clear(&original_code);
+		TekStk_push_many(&original_code, file->code, file->size);
+		for (uint32_t i = 0; i < run_edits_count; i += 1) {
+			TekLexerEdit edit = {0};
+			edit.code_idx = TekBenchGen_range(&gen, file->size + 1);
+			edit.deleted_len = TekBenchGen_range(&gen, tek_min(9u, file->size - edit.code_idx + 1));
+			edit.inserted = inserted;
+
+			uint32_t pick = TekBenchGen_range(&gen, 20);
+			if (pick < 6) {
+				uint32_t from = TekBenchGen_range(&gen, file->size + 1);
+				edit.inserted_len = TekBenchGen_range(&gen, tek_min(17u, file->size - from + 1));
+				tek_copy_bytes(inserted, &file->code[from], edit.inserted_len);
+			} else if (pick < 8) {
+				char* snippet = TekBenchGen_pick(&gen, TekBenchRelex_snippets);
+				edit.inserted_len = strlen(snippet);
+				tek_copy_bytes(inserted, snippet, edit.inserted_len);
+			} else if (pick < 10) {
+				edit.inserted_len = 1 + TekBenchGen_range(&gen, 3);
+				for (uint32_t j = 0; j < edit.inserted_len; j += 1) {
+					inserted[j] = TekBenchRelex_chars[TekBenchGen_range(&gen, sizeof(TekBenchRelex_chars) - 1)];
+				}
+			} else {
+				char* s = TekBenchGen_pick(&gen, TekBenchRelex_shorts);
+				edit.deleted_len = 0;
+				edit.inserted_len = strlen(s);
+				tek_copy_bytes(inserted, s, edit.inserted_len);
+			}
+
+			tek_copy_bytes(deleted, &file->code[edit.code_idx], edit.deleted_len);
+			TekLexerRelexResult res = TekBenchRelex_check_edit(c, w, file, &edit, &copy, counts);
+			if (res == TekLexerRelexResult_error && TekBenchGen_chance(&gen, 90)) {
+				TekLexerEdit undo = {
+					.code_idx = edit.code_idx,
+					.deleted_len = edit.inserted_len,
+					.inserted = deleted,
+					.inserted_len = edit.deleted_len,
+				};
+				TekBenchRelex_check_edit(c, w, file, &undo, &copy, counts);
+			}
+		}
+
+		//
+		// put the whole file back the way it was, so the errors that were not undone do not carry on into the next run.
+		TekLexerEdit revert = {
+			.code_idx = 0,
+			.deleted_len = file->size,
+			.inserted = original_code.TekStk_data,
+			.inserted_len = original_code.count,
+		};
+		TekBenchRelex_check_edit(c, w, file, &revert, &copy, counts);
+	}
+	TekBenchRelexCopy_deinit(&copy);
+	TekStk_deinit(&original_code);
+}
+
+//
+// @return: whether TekLexer_relex can insert TekBenchRelex_typed into @param(file).
+static TekBool TekBenchRelex_can_type(TekFile* file) {
+	if (file->tokens_count == 0) return tek_false;
+	return file->size + sizeof(TekBenchRelex_typed) <= file->segment_sizes[TekMemSegFile_code_buf];
+}
+
+//
+// @return: the start of a line near the middle of @param(file), so typing there never lands in a comment or string.
+static uint32_t TekBenchRelex_typing_code_idx(TekFile* file) {
+	uint32_t code_idx = file->size / 2;
+	while (code_idx && file->code[code_idx - 1] != '\n') code_idx -= 1;
+	return code_idx;
+}
+
+//
+// makes an edit for the span check and counts the tokens it relexed, if @param(is_clean_in_out) says the file lexed without errors before it.
+// an edit after an error lexes the rest of the file again, which is not what the span check is after.
+static void TekBenchRelex_span_edit(TekCompiler* c, TekWorker* w, TekFile* file, uint32_t code_idx, uint32_t deleted_len, char* inserted, uint32_t inserted_len, TekBool* is_clean_in_out, TekBenchRelexSpanCounts* counts) {
+	TekLexerEdit edit = { .code_idx = code_idx, .deleted_len = deleted_len, .inserted = inserted, .inserted_len = inserted_len };
+	TekLexerRelexSpan span;
+	TekLexerRelexResult res = TekLexer_relex(&w->lexer, c, file->id, &edit, &span);
+	tek_assert(res != TekLexerRelexResult_no_room, "file %u has no room for the relex span check", file->id);
+	atomic_store(&c->errors_count, 0);
+
+	if (*is_clean_in_out) {
+		counts->edits_count += 1;
+		counts->relexed_tokens_count += span.added_count;
+		if (span.added_count > counts->relexed_tokens_max) {
+			counts->relexed_tokens_max = span.added_count;
+			counts->relexed_tokens_max_file_size = file->size;
+		}
+		if (span.added_count > TekBenchRelex_span_tokens_max) {
+			counts->over_count += 1;
+			fprintf(stderr, "TekLexer_relex of file %u at %u deleting %u inserting \"%.*s\" relexed %u tokens, more than the %u allowed\n",
+				file->id, code_idx, deleted_len, inserted_len, inserted, span.added_count, TekBenchRelex_span_tokens_max);
+		}
+	}
+	*is_clean_in_out = res == TekLexerRelexResult_ok;
+}
+
+//
+// checks that an edit only relexes the tokens around it, however big the file is.
+// every file that TekLexer_relex can edit has TekBenchRelex_typed typed in and deleted again like the typing case,
+// then spaces are inserted at random places and deleted again like the random case. the files are left as they were.
+static void TekBenchRelex_span_check(TekCompiler* c, TekWorker* w, uint64_t seed, TekBenchRelexSpanCounts* counts) {
+	TekBenchGen gen = { .rng = seed };
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	uint32_t typed_len = sizeof(TekBenchRelex_typed) - 1;
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		if (!TekBenchRelex_can_type(file)) continue;
+		counts->files_count += 1;
+		counts->largest_file_size = tek_max(counts->largest_file_size, (uint64_t)file->size);
+
+		TekBool is_clean = tek_true;
+		uint32_t code_idx = TekBenchRelex_typing_code_idx(file);
+		for (uint32_t j = 0; j < typed_len; j += 1) {
+			TekBenchRelex_span_edit(c, w, file, code_idx + j, 0, &TekBenchRelex_typed[j], 1, &is_clean, counts);
+		}
+		for (uint32_t j = typed_len; j-- > 0;) {
+			TekBenchRelex_span_edit(c, w, file, code_idx + j, 1, "", 0, &is_clean, counts);
+		}
+
+		for (uint32_t j = 0; j < TekBenchRelex_random_edits_count; j += 2) {
+			code_idx = TekBenchGen_range(&gen, file->size + 1);
+			TekBenchRelex_span_edit(c, w, file, code_idx, 0, " ", 1, &is_clean, counts);
+			TekBenchRelex_span_edit(c, w, file, code_idx, 1, "", 0, &is_clean, counts);
+		}
+	}
+}
+
+//
+// @return: the largest file that TekLexer_relex can insert TekBenchRelex_typed into, or NULL if there is none.
+static TekFile* TekBenchRelex_time_file(TekCompiler* c) {
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	TekFile* largest = NULL;
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		if (!TekBenchRelex_can_type(file)) continue;
+		if (largest == NULL || file->size > largest->size) {
+			largest = file;
+		}
+	}
+	return largest;
+}
+
+static void TekBenchRelex_time_edit(TekCompiler* c, TekWorker* w, TekFile* file, uint32_t code_idx, uint32_t deleted_len, char* inserted, uint32_t inserted_len) {
+	TekLexerEdit edit = { .code_idx = code_idx, .deleted_len = deleted_len, .inserted = inserted, .inserted_len = inserted_len };
+	TekLexerRelexResult res = TekLexer_relex(&w->lexer, c, file->id, &edit, NULL);
+	tek_assert(res != TekLexerRelexResult_no_room, "file %u has no room for the relex benchmark", file->id);
+	atomic_store(&c->errors_count, 0);
+}
+
+//
+// @return: the mean time of one edit, or one full lex, in a single sample of @param(bc).
+static double TekBenchRelex_time_sample(TekCompiler* c, TekWorker* w, TekFile* file, TekBenchRelexCase bc, TekBenchGen* gen) {
+	double start_ms = TekBench_now_ms(tek_true);
+	uint32_t count = 0;
+	switch (bc) {
+		case TekBenchRelexCase_typing: {
+			uint32_t code_idx = TekBenchRelex_typing_code_idx(file);
+			uint32_t typed_len = sizeof(TekBenchRelex_typed) - 1;
+			for (uint32_t i = 0; i < typed_len; i += 1) {
+				TekBenchRelex_time_edit(c, w, file, code_idx + i, 0, &TekBenchRelex_typed[i], 1);
+			}
+			for (uint32_t i = typed_len; i-- > 0;) {
+				TekBenchRelex_time_edit(c, w, file, code_idx + i, 1, "", 0);
+			}
+			count = typed_len * 2;
+			break;
+		}
+		case TekBenchRelexCase_random:
+			for (uint32_t i = 0; i < TekBenchRelex_random_edits_count; i += 2) {
+				uint32_t code_idx = TekBenchGen_range(gen, file->size + 1);
+				TekBenchRelex_time_edit(c, w, file, code_idx, 0, " ", 1);
+				TekBenchRelex_time_edit(c, w, file, code_idx, 1, "", 0);
+			}
+			count = TekBenchRelex_random_edits_count;
+			break;
+		case TekBenchRelexCase_full: {
+			file->tokens_count = 0;
+			file->token_values_count = 0;
+			file->lines_count = 0;
+			TekBool success = TekLexer_lex(&w->lexer, c, file->id);
+			tek_assert(success, "failed to lex file %u for the relex benchmark", file->id);
+			tek_zero_elmt(&c->job_sys);
+			atomic_store(&c->jobs_count, 0);
+			count = 1;
+			break;
+		}
+	}
+	return (TekBench_now_ms(tek_true) - start_ms) / count;
+}
+
+//
+// runs the benchmark, the span check and then the check, and pushes the JSON results on to @param(out).
+// the benchmark and the span check leave the files as they were, the check leaves the files of the project edited.
+// @param(edits_count): about the number of edits the check makes, the undos are not counted.
+// @return: the number of edits that left a file different to lexing it from the start or relexed too many tokens.
+static uint64_t TekBenchRelex_run(TekCompiler* c, TekWorker* w, uint32_t edits_count, uint32_t iters, uint64_t seed, TekStk(char)* out) {
+	atomic_store(&c->errors_count, 0);
+
+	TekStk(char) results = {0};
+	TekFile* time_file = TekBenchRelex_time_file(c);
+	uint32_t time_file_size = time_file ? time_file->size : 0;
+	uint32_t time_file_tokens_count = time_file ? time_file->tokens_count : 0;
+	if (time_file) {
+		TekBenchGen gen = { .rng = seed };
+		double* samples_ms = tek_alloc_array(double, iters);
+		for (TekBenchRelexCase bc = 0; bc < TekBenchRelexCase_COUNT; bc += 1) {
+			//
+			// warm up first, so the first sample is not paying for page faults.
+			TekBenchRelex_time_sample(c, w, time_file, bc, &gen);
+			for (uint32_t i = 0; i < iters; i += 1) {
+				samples_ms[i] = TekBenchRelex_time_sample(c, w, time_file, bc, &gen);
+			}
+
+			TekBenchStats stats;
+			TekBench_stats(samples_ms, iters, &stats);
+			TekStk_push_str_fmt(&results,
+				"\t\t{ \"case\": \"%s\", \"median_us\": %.3f, \"best_us\": %.3f, \"ci_low_us\": %.3f, \"ci_high_us\": %.3f }%s\n",
+				TekBenchRelexCase_strings[bc], stats.median_ms * 1e3, stats.best_ms * 1e3,
+				stats.ci_low_ms * 1e3, stats.ci_high_ms * 1e3,
+				bc + 1 < TekBenchRelexCase_COUNT ? "," : "");
+		}
+		tek_dealloc_array(samples_ms, iters);
+	}
+
+	TekBenchRelexSpanCounts span_counts = {0};
+	TekBenchRelex_span_check(c, w, seed, &span_counts);
+
+	TekBenchRelexCounts counts = {0};
+	TekBenchRelex_check(c, w, edits_count, seed, &counts);
+
+	TekStk_push_str(out, "{\n");
+	TekStk_push_str_fmt(out, "\t\"config\": { \"edits\": %u, \"iters\": %u, \"seed\": %lu },\n", edits_count, iters, seed);
+	TekStk_push_str_fmt(out,
+		"\t\"check\": { \"edits\": %lu, \"ok\": %lu, \"error\": %lu, \"no_room\": %lu, \"synced\": %lu, \"relexed_tokens\": %lu, \"mismatches\": %lu },\n",
+		counts.edits_count, counts.ok_count, counts.error_count, counts.no_room_count,
+		counts.synced_count, counts.relexed_tokens_count, counts.mismatches_count);
+	TekStk_push_str_fmt(out,
+		"\t\"span\": { \"files\": %lu, \"largest_file_size\": %lu, \"edits\": %lu, \"relexed_tokens\": %lu, \"relexed_tokens_max\": %lu, \"relexed_tokens_max_file_size\": %lu, \"over\": %lu },\n",
+		span_counts.files_count, span_counts.largest_file_size, span_counts.edits_count, span_counts.relexed_tokens_count,
+		span_counts.relexed_tokens_max, span_counts.relexed_tokens_max_file_size, span_counts.over_count);
+	TekStk_push_str_fmt(out, "\t\"time_file\": { \"size\": %u, \"tokens\": %u },\n", time_file_size, time_file_tokens_count);
+	TekStk_push_str(out, "\t\"results\": [\n");
+	TekStk_push_many(out, results.TekStk_data, results.count);
+	TekStk_push_str(out, "\t]\n}\n");
+	TekStk_deinit(&results);
+	return counts.mismatches_count + span_counts.over_count;
+}
@@ -1,21 +1,376 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
 #include "deps/cmd_arger.h"
 #include "deps/cmd_arger.c"
+#include "deps/utf8proc.h"
+#include "deps/utf8proc.c"
 
 #define tekc_src_file "src/main.c"
 #define tekc_out_file "build/tekc"
+#define tekc_ident_tables_file "build/tek_ident_tables.h"
+#define tekc_keyword_table_file "build/tek_keyword_table.h"
+#define tekc_pow10_table_file "build/tek_pow10_table.h"
+#define tekc_bench_src_file "bench/bench.c"
+#define tekc_bench_out_file "build/tekc_bench"
+#define tekc_bench_huge_pages_out_file "build/tekc_bench_huge_pages"
+#define tekc_bench_baseline_file "bench/baseline.json"
+
+//
+// these must match the values of TekLexerIdentClass in src/lexer.c.
+// the generated file checks this with a static_assert.
+enum {
+	ident_class_invalid,
+	ident_class_delimiter,
+	ident_class_continue,
+};
+
+//
+// the rules for which codepoints can be in an identifier, are next to one, or end one.
+static int ident_class(int32_t codept) {
+	switch (utf8proc_category(codept)) {
+		case UTF8PROC_CATEGORY_LU: /**< Letter, uppercase */
+		case UTF8PROC_CATEGORY_LL: /**< Letter, lowercase */
+		case UTF8PROC_CATEGORY_LT: /**< Letter, titlecase */
+		case UTF8PROC_CATEGORY_LM: /**< Letter, modifier */
+		case UTF8PROC_CATEGORY_LO: /**< Letter, other */
+		case UTF8PROC_CATEGORY_ND: /**< Number, decimal digit */
+		case UTF8PROC_CATEGORY_NL: /**< Number, letter */
+		case UTF8PROC_CATEGORY_NO: /**< Number, other */
+			return ident_class_continue;
+		case UTF8PROC_CATEGORY_PC: /**< Punctuation, connector */
+			if (codept == '_') {
+				return ident_class_continue;
+			}
+			return ident_class_delimiter;
+		case UTF8PROC_CATEGORY_PD: /**< Punctuation, dash */
+		case UTF8PROC_CATEGORY_PS: /**< Punctuation, open */
+		case UTF8PROC_CATEGORY_PE: /**< Punctuation, close */
+		case UTF8PROC_CATEGORY_PI: /**< Punctuation, initial quote */
+		case UTF8PROC_CATEGORY_PF: /**< Punctuation, final quote */
+		case UTF8PROC_CATEGORY_PO: /**< Punctuation, other */
+		case UTF8PROC_CATEGORY_SM: /**< Symbol, math */
+		case UTF8PROC_CATEGORY_SC: /**< Symbol, currency */
+		case UTF8PROC_CATEGORY_SK: /**< Symbol, modifier */
+		case UTF8PROC_CATEGORY_SO: /**< Symbol, other */
+		case UTF8PROC_CATEGORY_ZS: /**< Separator, space */
+		case UTF8PROC_CATEGORY_ZL: /**< Separator, line */
+		case UTF8PROC_CATEGORY_ZP: /**< Separator, paragraph */
+			return ident_class_delimiter;
+		case UTF8PROC_CATEGORY_CC: /**< Other, control */
+			if (codept == '\n' || codept == '\r' || codept == '\t') {
+				return ident_class_delimiter;
+			}
+			return ident_class_invalid;
+		default:
+			return ident_class_invalid;
+	}
+}
+
+//
+// generates a two level table of the identifier class of every codepoint for the lexer.
+// the codepoints are split into blocks of 256 with 2 bits each, and identical blocks are only stored once.
+// the first level maps the top bits of a codepoint to its block.
+#define ident_tables_codepts_count 0x110000
+#define ident_tables_block_codepts_count 256
+#define ident_tables_blocks_cap (ident_tables_codepts_count / ident_tables_block_codepts_count)
+#define ident_tables_block_size (ident_tables_block_codepts_count / 4)
+static int gen_ident_tables(char* path) {
+	static unsigned char blocks[ident_tables_blocks_cap][ident_tables_block_size];
+	static unsigned short block_indices[ident_tables_blocks_cap];
+	unsigned int blocks_count = 0;
+
+	for (unsigned int i = 0; i < ident_tables_blocks_cap; i += 1) {
+		unsigned char block[ident_tables_block_size] = {0};
+		for (unsigned int j = 0; j < ident_tables_block_codepts_count; j += 1) {
+			int32_t codept = i * ident_tables_block_codepts_count + j;
+			block[j / 4] |= ident_class(codept) << ((j % 4) * 2);
+		}
+
+		unsigned int block_idx = 0;
+		while (block_idx < blocks_count && memcmp(blocks[block_idx], block, sizeof(block)) != 0) {
+			block_idx += 1;
+		}
+		if (block_idx == blocks_count) {
+			memcpy(blocks[blocks_count], block, sizeof(block));
+			blocks_count += 1;
+		}
+		block_indices[i] = block_idx;
+	}
+
+	FILE* f = fopen(path, "w");
+	if (f == NULL) { return 1; }
+
+	fprintf(f, "// generated by build_script.c from the utf8proc data, do not edit.\n");
+	fprintf(f, "static_assert(TekLexerIdentClass_invalid == %u && TekLexerIdentClass_delimiter == %u && TekLexerIdentClass_continue == %u, \"rebuild with build_script.c\");\n\n",
+		ident_class_invalid, ident_class_delimiter, ident_class_continue);
+
+	char* block_idx_type = blocks_count <= 256 ? "uint8_t" : "uint16_t";
+	fprintf(f, "static %s TekLexerIdentClass_block_indices[%u] = {", block_idx_type, ident_tables_blocks_cap);
+	for (unsigned int i = 0; i < ident_tables_blocks_cap; i += 1) {
+		fprintf(f, "%s%u,", i % 32 ? " " : "\n\t", block_indices[i]);
+	}
+	fprintf(f, "\n};\n\n");
+
+	fprintf(f, "static uint8_t TekLexerIdentClass_blocks[%u][%u] = {\n", blocks_count, ident_tables_block_size);
+	for (unsigned int i = 0; i < blocks_count; i += 1) {
+		fprintf(f, "\t{");
+		for (unsigned int j = 0; j < ident_tables_block_size; j += 1) {
+			fprintf(f, "%s0x%02x,", j % 16 ? " " : "\n\t\t", blocks[i][j]);
+		}
+		fprintf(f, "\n\t},\n");
+	}
+	fprintf(f, "};\n");
+
+	return fclose(f) == 0 ? 0 : 1;
+}
+
+//
+// the keywords and directives that the lexer turns into their own tokens.
+// to add one, add it to TekToken and here, the table is regenerated on the next build.
+typedef struct {
+	char* str;
+	char* token;
+} Keyword;
+
+static Keyword keywords[] = {
+	{ "if", "TekToken_if" },
+	{ "as", "TekToken_as" },
+	{ "in", "TekToken_in" },
+	{ "var", "TekToken_var" },
+	{ "mut", "TekToken_mut" },
+	{ "mod", "TekToken_mod" },
+	{ "for", "TekToken_for" },
+	{ "lib", "TekToken_lib" },
+	{ "else", "TekToken_else" },
+	{ "proc", "TekToken_proc" },
+	{ "case", "TekToken_case" },
+	{ "loop", "TekToken_loop" },
+	{ "enum", "TekToken_enum" },
+	{ "goto", "TekToken_goto" },
+	{ "#abi", "TekToken_directive_abi" },
+	{ "defer", "TekToken_defer" },
+	{ "match", "TekToken_match" },
+	{ "union", "TekToken_union" },
+	{ "alias", "TekToken_alias" },
+	{ "macro", "TekToken_macro" },
+	{ "#type", "TekToken_directive_type" },
+	{ "#expr", "TekToken_directive_expr" },
+	{ "#stmt", "TekToken_directive_stmt" },
+	{ "return", "TekToken_return" },
+	{ "struct", "TekToken_struct" },
+	{ "interf", "TekToken_interf" },
+	{ "#error", "TekToken_directive_error" },
+	{ "#flags", "TekToken_directive_flags" },
+	{ "#import", "TekToken_directive_import" },
+	{ "#inline", "TekToken_directive_inline" },
+	{ "#extern", "TekToken_directive_extern" },
+	{ "continue", "TekToken_continue" },
+	{ "#noalias", "TekToken_directive_noalias" },
+	{ "#bitfield", "TekToken_directive_bitfield" },
+	{ "#distinct", "TekToken_directive_distinct" },
+	{ "#noreturn", "TekToken_directive_noreturn" },
+	{ "#volatile", "TekToken_directive_volatile" },
+	{ "#call_conv", "TekToken_directive_call_conv" },
+	{ "#intrinsic", "TekToken_directive_intrinsic" },
+	{ "#fallthrough", "TekToken_directive_fallthrough" },
+	{ "#compound_type", "TekToken_directive_compound_type" },
+};
+
+//
+// the keywords are packed into 16 bytes padded with zeros, which is how the lexer loads an identifier.
+// these must match TekLexerKeyword_hash in src/lexer.c.
+#define keyword_table_size_log2 7
+#define keyword_packed_size 16
+
+static uint64_t keyword_hash(uint64_t* packed, uint64_t mult) {
+	return ((packed[0] ^ (packed[1] * 0x9e3779b97f4a7c15ull)) * mult) >> (64 - keyword_table_size_log2);
+}
+
+//
+// searches for a multiplier that gives every keyword its own slot in the table.
+// so the lexer only has to hash an identifier and compare it with one entry.
+static int gen_keyword_table(char* path) {
+	unsigned int keywords_count = sizeof(keywords) / sizeof(*keywords);
+	uint64_t packed[sizeof(keywords) / sizeof(*keywords)][2];
+	for (unsigned int i = 0; i < keywords_count; i += 1) {
+		if (strlen(keywords[i].str) > keyword_packed_size) {
+			printf("keyword '%s' is longer than %u bytes\n", keywords[i].str, keyword_packed_size);
+			return 1;
+		}
+		memset(packed[i], 0, sizeof(packed[i]));
+		memcpy(packed[i], keywords[i].str, strlen(keywords[i].str));
+	}
+
+	int slots[1 << keyword_table_size_log2];
+	uint64_t mult = 0;
+	uint64_t seed = 0;
+	while (1) {
+		//
+		// the next candidate multiplier from splitmix64, it must be odd.
+		seed += 0x9e3779b97f4a7c15ull;
+		uint64_t z = seed;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		mult = (z ^ (z >> 31)) | 1;
+
+		memset(slots, -1, sizeof(slots));
+		unsigned int i = 0;
+		for (; i < keywords_count; i += 1) {
+			uint64_t slot = keyword_hash(packed[i], mult);
+			if (slots[slot] != -1) break;
+			slots[slot] = i;
+		}
+		if (i == keywords_count) break;
+	}
+
+	FILE* f = fopen(path, "w");
+	if (f == NULL) { return 1; }
+
+	fprintf(f, "// generated by build_script.c from its keywords array, do not edit.\n");
+	fprintf(f, "#define TekLexerKeyword_hash_mult 0x%016llxull\n", (unsigned long long)mult);
+	fprintf(f, "#define TekLexerKeyword_table_size_log2 %u\n\n", keyword_table_size_log2);
+	fprintf(f, "static TekLexerKeyword TekLexerKeyword_table[%u] = {\n", 1 << keyword_table_size_log2);
+	for (unsigned int slot = 0; slot < (1 << keyword_table_size_log2); slot += 1) {
+		if (slots[slot] == -1) continue;
+		unsigned int i = slots[slot];
+		fprintf(f, "\t[%u] = { .packed = { 0x%016llxull, 0x%016llxull }, .token = %s }, // %s\n",
+			slot, (unsigned long long)packed[i][0], (unsigned long long)packed[i][1], keywords[i].token, keywords[i].str);
+	}
+	fprintf(f, "};\n");
+
+	return fclose(f) == 0 ? 0 : 1;
+}
+
+//
+// the range of the powers of ten in the table, this covers every exponent a double can have.
+#define pow10_table_min_exp10 -342
+#define pow10_table_max_exp10 308
+#define pow10_big_limbs_cap 32
+
+//
+// a big unsigned integer with the least significant limb first, just enough to compute the powers of five.
+typedef struct {
+	uint32_t limbs[pow10_big_limbs_cap];
+} Pow10Big;
+
+static void pow10_big_mul_small(Pow10Big* big, uint32_t by) {
+	uint64_t carry = 0;
+	for (unsigned int i = 0; i < pow10_big_limbs_cap; i += 1) {
+		uint64_t v = (uint64_t)big->limbs[i] * by + carry;
+		big->limbs[i] = (uint32_t)v;
+		carry = v >> 32;
+	}
+}
+
+static int pow10_big_cmp(Pow10Big* a, Pow10Big* b) {
+	for (unsigned int i = pow10_big_limbs_cap; i-- > 0;) {
+		if (a->limbs[i] != b->limbs[i]) return a->limbs[i] < b->limbs[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+static void pow10_big_sub(Pow10Big* a, Pow10Big* b) {
+	uint64_t borrow = 0;
+	for (unsigned int i = 0; i < pow10_big_limbs_cap; i += 1) {
+		uint64_t v = (uint64_t)a->limbs[i] - b->limbs[i] - borrow;
+		a->limbs[i] = (uint32_t)v;
+		borrow = (v >> 32) & 1;
+	}
+}
+
+static unsigned int pow10_big_bit(Pow10Big* big, unsigned int bit) {
+	return (big->limbs[bit / 32] >> (bit % 32)) & 1;
+}
+
+static unsigned int pow10_big_bits_count(Pow10Big* big) {
+	for (unsigned int i = pow10_big_limbs_cap * 32; i-- > 0;) {
+		if (pow10_big_bit(big, i)) return i + 1;
+	}
+	return 0;
+}
+
+//
+// generates the 128 most significant bits of every power of ten in the table's range, rounded down.
+// 10^e is 5^e * 2^e so these are the same as the powers of five, the lexer works out the power of two itself.
+// these are used by the Eisel-Lemire float parser in src/lexer.c.
+static int gen_pow10_table(char* path) {
+	static uint64_t table[pow10_table_max_exp10 - pow10_table_min_exp10 + 1][2];
+	for (int exp10 = pow10_table_min_exp10; exp10 <= pow10_table_max_exp10; exp10 += 1) {
+		Pow10Big pow5 = { .limbs = { 1 } };
+		for (int i = 0; i < (exp10 < 0 ? -exp10 : exp10); i += 1) {
+			pow10_big_mul_small(&pow5, 5);
+		}
+
+		uint64_t* entry = table[exp10 - pow10_table_min_exp10];
+		if (exp10 >= 0) {
+			//
+			// take the top 128 bits of 5^e, padding with zeros when it is shorter.
+			int bits_count = pow10_big_bits_count(&pow5);
+			for (int i = 0; i < 128; i += 1) {
+				int bit = bits_count - 1 - i;
+				unsigned int value = bit >= 0 ? pow10_big_bit(&pow5, bit) : 0;
+				entry[i / 64] |= (uint64_t)value << (63 - (i % 64));
+			}
+		} else {
+			//
+			// long divide 1 by 5^-e one bit at a time, until 128 bits of the quotient have been found after its leading one.
+			Pow10Big remainder = { .limbs = { 1 } };
+			int quotient_bits_count = 0;
+			while (quotient_bits_count < 128) {
+				unsigned int value = 0;
+				if (pow10_big_cmp(&remainder, &pow5) >= 0) {
+					pow10_big_sub(&remainder, &pow5);
+					value = 1;
+				}
+				if (value || quotient_bits_count) {
+					entry[quotient_bits_count / 64] |= (uint64_t)value << (63 - (quotient_bits_count % 64));
+					quotient_bits_count += 1;
+				}
+				pow10_big_mul_small(&remainder, 2);
+			}
+		}
+	}
+
+	FILE* f = fopen(path, "w");
+	if (f == NULL) { return 1; }
+
+	fprintf(f, "// generated by build_script.c, do not edit.\n");
+	fprintf(f, "#define TekLexerPow10_min_exp10 %d\n", pow10_table_min_exp10);
+	fprintf(f, "#define TekLexerPow10_max_exp10 %d\n\n", pow10_table_max_exp10);
+	fprintf(f, "static uint64_t TekLexerPow10_table[%d][2] = {\n", pow10_table_max_exp10 - pow10_table_min_exp10 + 1);
+	for (int exp10 = pow10_table_min_exp10; exp10 <= pow10_table_max_exp10; exp10 += 1) {
+		uint64_t* entry = table[exp10 - pow10_table_min_exp10];
+		fprintf(f, "\t{ 0x%016llxull, 0x%016llxull }, // 1e%d\n", (unsigned long long)entry[0], (unsigned long long)entry[1], exp10);
+	}
+	fprintf(f, "};\n");
+
+	return fclose(f) == 0 ? 0 : 1;
+}
+
+//
+// system returns the wait status of the command, which is not an exit code.
+// returning it from main as is, would turn a failure with an exit code of 1 into a success.
+static int system_exit_code(int res) {
+	return WIFEXITED(res) ? WEXITSTATUS(res) : 1;
+}
 
 int main(int argc, char** argv) {
 	CmdArgerBool debug = cmd_arger_false;
 	CmdArgerBool debug_address = cmd_arger_false;
 	CmdArgerBool debug_memory = cmd_arger_false;
 	CmdArgerBool clean = cmd_arger_false;
+	CmdArgerBool bench = cmd_arger_false;
+	CmdArgerBool bench_gate = cmd_arger_false;
 
 	char* compiler = "clang";
 	int64_t opt = 0;
 	CmdArgerDesc desc[] = {
 		cmd_arger_desc_flag(&debug, "debug", "compile in debuggable executable"),
 		cmd_arger_desc_flag(&clean, "clean", "remove any built binaries"),
+		cmd_arger_desc_flag(&bench, "bench", "also build the benchmarks and run them, the results are written to build/bench.json, build/bench_huge_pages.json and build/bench_containers.json"),
+		cmd_arger_desc_flag(&bench_gate, "bench_gate", "also build the benchmarks and compare the lexer, parser and string table to "tekc_bench_baseline_file", fails if any are significantly slower, a float literal is parsed differently to strtod, or a relex differs from a full lex"),
 		cmd_arger_desc_flag(&debug_address, "debug_address", "turns on address sanitizer"),
 		cmd_arger_desc_flag(&debug_memory, "debug_memory", "turns on address memory sanitizer"),
 		cmd_arger_desc_string(&compiler, "compiler", "the compiler command"),
@@ -53,17 +408,74 @@ int main(int argc, char** argv) {
 		env_cflags = "";
 	}
 
-	char* include_paths = "-I./";
+	char* include_paths = "-I./ -I./build";
 
 	// ensure the build directory exists
 	exe_res = system("mkdir -p build");
 	if (exe_res != 0) { return exe_res; }
 
+	// generate the lexer's identifier tables
+	exe_res = gen_ident_tables(tekc_ident_tables_file);
+	if (exe_res != 0) { return exe_res; }
+
+	// generate the lexer's keyword table
+	exe_res = gen_keyword_table(tekc_keyword_table_file);
+	if (exe_res != 0) { return exe_res; }
+
+	// generate the lexer's table of powers of ten for parsing floats
+	exe_res = gen_pow10_table(tekc_pow10_table_file);
+	if (exe_res != 0) { return exe_res; }
+
 	// compile tekc
 	snprintf(buf, buf_count, "%s %s %s -o %s %s %s", compiler, env_cflags, cflags, tekc_out_file, tekc_src_file, include_paths);
 	exe_res = system(buf);
 	if (exe_res != 0) { return exe_res; }
 
+	//
+	// the benchmarks are always optimized and do not dump the tokens and syntax trees.
+	char* bench_cflags = opt < 2 ? "-O2 -DTEK_DEBUG_TOKENS=0 -DTEK_DEBUG_SYNTAX_TREE=0" : "-DTEK_DEBUG_TOKENS=0 -DTEK_DEBUG_SYNTAX_TREE=0";
+	if (bench || bench_gate) {
+		snprintf(buf, buf_count, "%s %s %s %s -o %s %s %s -lm", compiler, env_cflags, cflags, bench_cflags, tekc_bench_out_file, tekc_bench_src_file, include_paths);
+		exe_res = system(buf);
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+	}
+
+	if (bench_gate) {
+		//
+		// the exit code of the benchmarks says whether anything regressed, so pass it on.
+		// to record a new baseline, run this command with --out bench/baseline.json instead of --baseline.
+		exe_res = system("./"tekc_bench_out_file" --gate --iters 15 --baseline "tekc_bench_baseline_file" --out build/bench_gate.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+
+		//
+		// the float literal parser must give the same doubles as strtod.
+		exe_res = system("./"tekc_bench_out_file" --floats --out build/bench_floats.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+
+		//
+		// relexing an edit must leave the same tokens as lexing the edited file from the start,
+		// and only relex the tokens around the edit.
+		exe_res = system("./"tekc_bench_out_file" --relex --out build/bench_relex.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+	}
+
+	if (bench) {
+		//
+		// transparent huge pages are a compile time option, so there is a second build with them turned on.
+		snprintf(buf, buf_count, "%s %s %s %s -DTEK_HUGE_PAGES=1 -o %s %s %s -lm", compiler, env_cflags, cflags, bench_cflags, tekc_bench_huge_pages_out_file, tekc_bench_src_file, include_paths);
+		exe_res = system(buf);
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+
+		exe_res = system("./"tekc_bench_out_file" --out build/bench.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+
+		exe_res = system("./"tekc_bench_huge_pages_out_file" --out build/bench_huge_pages.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+
+		exe_res = system("./"tekc_bench_out_file" --containers --out build/bench_containers.json");
+		if (exe_res != 0) { return system_exit_code(exe_res); }
+	}
+
 	return exe_res;
 }
 
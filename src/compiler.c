@@ -17,14 +17,16 @@ TekJobId _TekCompiler_job_list_take(TekCompiler* c, TekJobList* list) {
 	TekJobId head_id = list->head;
 	if (head_id) {
 		//
-		// take from the list head by setting the next job as the head job
-		TekJob* head = _TekCompiler_job_get(c, head_id);
-		list->head = head->next;
-
-		//
-		// set the tail to null if we have reached the end of the list
+		// set the head and tail to null if we have reached the end of the list.
+		// the next of the tail job is not cleared when it is added, so it cannot be followed here.
 		if (list->tail == head_id) {
+			list->head = 0;
 			list->tail = 0;
+		} else {
+			//
+			// take from the list head by setting the next job as the head job
+			TekJob* head = _TekCompiler_job_get(c, head_id);
+			list->head = head->next;
 		}
 	}
 
@@ -160,6 +162,151 @@ void _TekCompiler_job_finish(TekCompiler* c, TekJobId job_id, TekBool success_tr
 	}
 }
 
+static void _TekFile_segment_bounds(uintptr_t code_size, uintptr_t* sizes_out);
+static void _TekFile_segment_used_sizes(TekFile* file, uintptr_t* used_sizes_out);
+
+//
+// the most bytes a file can commit from when it starts lexing until its syntax tree is built.
+// this is the sum of the segment bounds for the size of its code, see TekFile_segment_sizes.
+// once @param(is_lexed), the tokens and lines are the size that they ended up, and only the syntax tree is a bound.
+// the code is not counted, as it has been loaded before the lex job is run.
+static uintptr_t _TekFile_in_flight_size(TekFile* file, TekBool is_lexed) {
+	uintptr_t sizes[TekMemSegFile_COUNT];
+	_TekFile_segment_bounds(file->size, sizes);
+	if (is_lexed) {
+		uintptr_t used_sizes[TekMemSegFile_COUNT];
+		_TekFile_segment_used_sizes(file, used_sizes);
+		for (uint32_t i = 0; i < TekMemSegFile_syntax_tree_nodes; i += 1) {
+			sizes[i] = used_sizes[i];
+		}
+		uintptr_t nodes_cap = ((uintptr_t)file->tokens_count + 1) * tek_syn_nodes_per_token_max;
+		sizes[TekMemSegFile_syntax_tree_nodes] = nodes_cap * sizeof(TekSynNode);
+		sizes[TekMemSegFile_syntax_tree_array_node_indices] = nodes_cap * sizeof(uint32_t);
+	}
+
+	uintptr_t page_size = tek_virt_mem_page_size();
+	uintptr_t size = 0;
+	for (uint32_t i = 0; i < TekMemSegFile_COUNT; i += 1) {
+		if (i == TekMemSegFile_code_buf) continue;
+		size += (uintptr_t)tek_ptr_round_up_align((void*)sizes[i], page_size);
+	}
+	return size;
+}
+
+static void _TekCompiler_deferred_lex_job_requeue(TekCompiler* c) {
+	TekJobId job_id = _TekCompiler_job_list_take(c, &c->job_sys.deferred_lex_list);
+	if (job_id == 0) return;
+
+	_TekCompiler_job_list_add(c, &c->job_sys.type_to_job_list_map[TekJobType_lex_file], job_id);
+	atomic_fetch_add(&c->job_sys.available_count, 1);
+}
+
+//
+// called before a lex job is run when there is a TekCompileArgs.mem_limit.
+// if the file fits in the memory limit, it is counted as in flight until its syntax tree is built.
+// otherwise the job is deferred until another file has finished and tek_false is returned.
+static TekBool _TekCompiler_lex_job_admit(TekCompiler* c, TekJobId job_id, TekFileId file_id) {
+	uintptr_t mem_limit = c->compile_args->mem_limit;
+	TekFile* file = TekCompiler_file_get(c, file_id);
+	uintptr_t size = _TekFile_in_flight_size(file, tek_false);
+	uintptr_t in_flight_size = atomic_load(&c->files_in_flight_size);
+	while (1) {
+		//
+		// a file is always let through when nothing else is in flight,
+		// so files that are bigger than the limit on their own still get compiled.
+		if (in_flight_size && in_flight_size + size > mem_limit) {
+			break;
+		}
+
+		if (atomic_compare_exchange_weak(&c->files_in_flight_size, &in_flight_size, in_flight_size + size)) {
+			file->in_flight_size = size;
+			//
+			// there may still be room for the next deferred file.
+			if (in_flight_size + size < mem_limit) {
+				_TekCompiler_deferred_lex_job_requeue(c);
+			}
+			return tek_true;
+		}
+	}
+
+	_TekCompiler_job_list_add(c, &c->job_sys.deferred_lex_list, job_id);
+
+	//
+	// a file may have finished between the check above and deferring the job,
+	// in which case it would not have found this job to requeue. so check again.
+	in_flight_size = atomic_load(&c->files_in_flight_size);
+	if (in_flight_size == 0 || in_flight_size + size <= mem_limit) {
+		_TekCompiler_deferred_lex_job_requeue(c);
+	}
+	return tek_false;
+}
+
+static void _TekCompiler_file_stage_finish(TekCompiler* c, TekFileId file_id, TekJobType type) {
+	TekFile* file = TekCompiler_file_get(c, file_id);
+
+	//
+	// once the file is lexed, the tokens are known, so only what the syntax tree can still commit stays counted.
+	// the syntax tree is the last stage that commits memory in proportion to the file, so then nothing stays counted.
+	// either way, make room for a deferred file.
+	if ((type == TekJobType_lex_file || type == TekJobType_gen_syn_file) && c->compile_args->mem_limit) {
+		uintptr_t size = type == TekJobType_lex_file ? _TekFile_in_flight_size(file, tek_true) : 0;
+		if (size < file->in_flight_size) {
+			atomic_fetch_sub(&c->files_in_flight_size, file->in_flight_size - size);
+			file->in_flight_size = size;
+			_TekCompiler_deferred_lex_job_requeue(c);
+		}
+	}
+
+	//
+	// decommit the segments that will no longer be read by any other job.
+	for (uint32_t i = 0; i < TekMemSegFile_COUNT; i += 1) {
+		if (TekMemSegFile_last_job_types[i] == type) {
+			tek_virt_mem_decommit(file->segments[i], file->segment_sizes[i]);
+		}
+	}
+
+	//
+	// the syntax tree is the last stage that is run on a file for now.
+	if (type == TekJobType_gen_syn_file) {
+		atomic_store(&file->mem_state, TekFileMemState_finished);
+	}
+}
+
+TekTokenLoc TekFile_token_loc(TekFile* file, uint32_t token_idx) {
+	TekTokenLocCompact compact_loc = TekFile_token_loc_compact(file, token_idx);
+	TekTokenLoc loc = {
+		.code_idx_start = compact_loc.code_idx_start,
+		.code_idx_end = compact_loc.code_idx_end,
+	};
+
+	//
+	// binary search for the number of lines that start at or before the token.
+	// line_code_start_indices[i] is where line i + 1 starts, the first line starts at 0.
+	uint32_t start = 0;
+	uint32_t end = file->lines_count;
+	while (start < end) {
+		uint32_t mid = start + (end - start) / 2;
+		if (TekFile_line_code_start_idx(file, mid) <= loc.code_idx_start) {
+			start = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	loc.line = start;
+
+	//
+	// the columns of the first line start at 0 and the rest start at 1.
+	if (loc.line == 0) {
+		loc.column = loc.code_idx_start;
+	} else {
+		loc.column = loc.code_idx_start - TekFile_line_code_start_idx(file, loc.line - 1) + 1;
+	}
+
+	return loc;
+}
+
+static TekBool _TekCompiler_out_of_mem_handler(void* data, uintptr_t size, uint32_t fail_num);
+
 int _TekWorker_main(void* args) {
 	TekWorker* w = args;
 	TekCompiler* c = w->c;
@@ -176,6 +323,13 @@ int _TekWorker_main(void* args) {
 		}
 	}
 
+	//
+	// when there is a memory limit, try to give back memory that is not in use before failing.
+	TekOutOfMemHandler prev_out_of_mem_handler = tek_out_of_mem_handler;
+	if (c->compile_args->mem_limit) {
+		tek_out_of_mem_handler = (TekOutOfMemHandler) { .fn = _TekCompiler_out_of_mem_handler, .data = c };
+	}
+
 	//
 	// if this is the first worker, setup the first job by creating the first library and file.
 	if (w == TekCompiler_workers(c)) {
@@ -192,6 +346,10 @@ int _TekWorker_main(void* args) {
 		TekJob* job = _TekCompiler_job_get(c, job_id);
 		type = job->type;
 
+		if (type == TekJobType_lex_file && c->compile_args->mem_limit && !_TekCompiler_lex_job_admit(c, job_id, job->file_id)) {
+			continue;
+		}
+
 		TekBool success = tek_false;
 		switch (type) {
 			case TekJobType_lex_file:
@@ -205,9 +363,12 @@ int _TekWorker_main(void* args) {
 				tek_abort("unhandled job type '%u'", type);
 		}
 
+		_TekCompiler_file_stage_finish(c, job->file_id, type);
 		_TekCompiler_job_finish(c, job_id, success);
 	}
 
+	tek_out_of_mem_handler = prev_out_of_mem_handler;
+
 	if (atomic_fetch_sub(&c->running_workers_count, 1) == 1) {
 		//
 		// unlock the mutex for the TekCompiler_compile_wait function.
@@ -218,80 +379,400 @@ int _TekWorker_main(void* args) {
 	return 0;
 }
 
-TekVirtMemError tek_mem_segs_reserve(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments_out) {
+uintptr_t tek_mem_segs_layout(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void* mem, void** segments_out) {
 	uintptr_t page_size = tek_virt_mem_page_size();
 
-	uintptr_t total_size = 0;
+	uintptr_t offset = 0;
 	for (uint32_t i = 0; i < memsegs_count; i += 1) {
 		uintptr_t size = memsegs_sizes[i];
 		tek_assert(
-			size > page_size && size % page_size == 0,
-			"segment index '%u' with size of '0x%x(%zu)' must be greater than and a multiple of the page size '%u'",
+			size >= page_size && size % page_size == 0,
+			"segment index '%u' with size of '0x%x(%zu)' must be at least and a multiple of the page size '%u'",
 			i, size, size, page_size);
-		total_size += size;
+
+		//
+		// segments that are big enough to hold a huge page start on a huge page boundary.
+		// the start of the group is huge page aligned in this case, so aligning the offset is enough.
+		if ((flags & TekMemSegsFlags_huge_pages) && size >= tek_huge_page_size) {
+			offset = (uintptr_t)tek_ptr_round_up_align((void*)offset, tek_huge_page_size);
+		}
+
+		if (segments_out) {
+			segments_out[i] = tek_ptr_add(mem, offset);
+		}
+		offset += size;
+
+		// leave space for the guard page that sits directly after.
+		if (flags & TekMemSegsFlags_guard_pages) {
+			offset += page_size;
+		}
 	}
 
-	// add the size for all of the guard pages that sit directly after.
-	total_size += memsegs_count * page_size;
+	return offset;
+}
 
-	total_size = (uintptr_t)tek_ptr_round_up_align((void*)total_size, page_size);
+TekVirtMemError tek_mem_segs_reserve(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void** segments_out) {
+	uintptr_t page_size = tek_virt_mem_page_size();
+	uintptr_t total_size = tek_mem_segs_layout(memsegs_count, memsegs_sizes, flags, NULL, NULL);
 
 	//
-	// reserve memory for all the memory all at once
-	void* mem = tek_virt_mem_reserve(NULL, total_size, TekVirtMemProtection_read_write);
+	// reserve memory for all the memory all at once.
+	// for huge pages, reserve an extra huge page so the start can be aligned to one.
+	uintptr_t reserve_size = total_size;
+	if (flags & TekMemSegsFlags_huge_pages) {
+		reserve_size += tek_huge_page_size;
+	}
+	void* mem = tek_virt_mem_reserve(NULL, reserve_size, TekVirtMemProtection_read_write);
 	if (mem == NULL) {
 		return tek_virt_mem_get_last_error();
 	}
 
-	//
-	// store the segments pointers in segments_out and mark the guard page.
+	if (flags & TekMemSegsFlags_huge_pages) {
+		//
+		// give back the memory before and after the aligned group.
+		void* aligned_mem = tek_ptr_round_up_align(mem, tek_huge_page_size);
+		uintptr_t head_size = tek_ptr_diff(aligned_mem, mem);
+		uintptr_t tail_size = tek_huge_page_size - head_size;
+		if (head_size) tek_virt_mem_release(mem, head_size);
+		if (tail_size) tek_virt_mem_release(tek_ptr_add(aligned_mem, total_size), tail_size);
+		mem = aligned_mem;
+	}
+
+	tek_mem_segs_layout(memsegs_count, memsegs_sizes, flags, mem, segments_out);
+
 	for (uintptr_t i = 0; i < memsegs_count; i += 1) {
-		segments_out[i] = mem;
-		mem = tek_ptr_add(mem, memsegs_sizes[i]);
+		void* segment_end = tek_ptr_add(segments_out[i], memsegs_sizes[i]);
 
-		// mark the guard page after the group as no access.
-		if (!tek_virt_mem_protection_set(mem, page_size, TekVirtMemProtection_no_access)) {
-			return tek_virt_mem_get_last_error();
+		// mark the guard page after the segment as no access.
+		if (flags & TekMemSegsFlags_guard_pages) {
+			if (!tek_virt_mem_protection_set(segment_end, page_size, TekVirtMemProtection_no_access)) {
+				return tek_virt_mem_get_last_error();
+			}
+		}
+
+		//
+		// ask for the segment to be backed by huge pages.
+		// this is only advice, so the segment still works fine if it is not taken.
+		if ((flags & TekMemSegsFlags_huge_pages) && memsegs_sizes[i] >= tek_huge_page_size) {
+			tek_virt_mem_huge_pages_advise(segments_out[i], memsegs_sizes[i]);
 		}
-		mem = tek_ptr_add(mem, page_size);
 	}
 
 	return 0;
 }
 
-TekVirtMemError tek_mem_segs_reset(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments) {
-	//
-	// decommit all the segments so the memory can return to the OS and it'll all be zeroed apon next access.
+TekVirtMemError tek_mem_segs_reset(uint8_t memsegs_count, uintptr_t* memsegs_used_sizes, uintptr_t warm_size, void** segments) {
+	uintptr_t page_size = tek_virt_mem_page_size();
+
 	for (uintptr_t i = 0; i < memsegs_count; i += 1) {
-		if (!tek_virt_mem_decommit(segments[i], memsegs_sizes[i])) {
-			return tek_virt_mem_get_last_error();
+		uintptr_t used_size = (uintptr_t)tek_ptr_round_up_align((void*)memsegs_used_sizes[i], page_size);
+
+		//
+		// the start of the segment is kept committed and zeroed by hand,
+		// so the next use does not have to fault those pages back in.
+		uintptr_t seg_warm_size = tek_min(used_size, warm_size);
+		tek_zero_bytes(segments[i], seg_warm_size);
+
+		//
+		// decommit the rest so the memory can return to the OS and it'll all be zeroed apon next access.
+		if (used_size > seg_warm_size) {
+			if (!tek_virt_mem_decommit(tek_ptr_add(segments[i], seg_warm_size), used_size - seg_warm_size)) {
+				return tek_virt_mem_get_last_error();
+			}
 		}
 	}
 
 	return 0;
 }
 
-TekVirtMemError tek_mem_segs_release(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments_in_out) {
-	uintptr_t page_size = tek_virt_mem_page_size();
-
+TekVirtMemError tek_mem_segs_release(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void** segments_in_out) {
 	//
-	// release all the segments
+	// the segments all live in a single reservation that starts at the first segment,
+	// so release it all in one go.
+	uintptr_t total_size = tek_mem_segs_layout(memsegs_count, memsegs_sizes, flags, NULL, NULL);
+	if (!tek_virt_mem_release(segments_in_out[0], total_size)) {
+		return tek_virt_mem_get_last_error();
+	}
+
 	for (uintptr_t i = 0; i < memsegs_count; i += 1) {
-		if (!tek_virt_mem_release(segments_in_out[i], memsegs_sizes[i])) {
-			return tek_virt_mem_get_last_error();
+		segments_in_out[i] = NULL;
+	}
+
+	return 0;
+}
+
+//
+// the most bytes each segment of a file can use with @param(code_size) bytes of code, before rounding up to pages.
+static void _TekFile_segment_bounds(uintptr_t code_size, uintptr_t* sizes_out) {
+	//
+	// every token is at least one byte of code, so there can never be more tokens than bytes.
+	// the +1 is for the end of file token and the line count can be one more than the newlines.
+	uintptr_t max_count = code_size + 1;
+	sizes_out[TekMemSegFile_token_locs] = max_count * sizeof(TekTokenLocCompact);
+	sizes_out[TekMemSegFile_tokens] = max_count * sizeof(TekToken);
+	sizes_out[TekMemSegFile_token_values] = max_count * sizeof(TekValue);
+	sizes_out[TekMemSegFile_bracket_matches] = max_count * sizeof(uint32_t);
+	sizes_out[TekMemSegFile_string_buf] = code_size;
+	sizes_out[TekMemSegFile_line_code_start_indices] = max_count * sizeof(uintptr_t);
+	sizes_out[TekMemSegFile_syntax_tree_nodes] = max_count * tek_syn_nodes_per_token_max * sizeof(TekSynNode);
+	sizes_out[TekMemSegFile_syntax_tree_array_node_indices] = max_count * tek_syn_nodes_per_token_max * sizeof(uint32_t);
+	//
+	// files that are memory mapped still reserve a code_buf, as TekLexer_relex copies their code into it.
+	// it is only committed once they are edited.
+	sizes_out[TekMemSegFile_code_buf] = code_size;
+}
+
+void TekFile_segment_sizes(uint8_t seg_class, uintptr_t* sizes_out) {
+	uintptr_t code_size = (uintptr_t)1 << (seg_class + TekFileSegClass_min_code_size_log2);
+	_TekFile_segment_bounds(code_size, sizes_out);
+
+	//
+	// every segment needs to be at least a page and a multiple of the page size.
+	uintptr_t page_size = tek_virt_mem_page_size();
+	for (uint32_t i = 0; i < TekMemSegFile_COUNT; i += 1) {
+		uintptr_t size = tek_max(sizes_out[i], page_size);
+		sizes_out[i] = (uintptr_t)tek_ptr_round_up_align((void*)size, page_size);
+	}
+}
+
+static_assert(sizeof(TekSegGroupPool) <= Tek16MB, "TekSegGroupPool does not fit in the TekMemSegCompiler_seg_group_pool segment");
+
+//
+// the file segments sit right next to each other without guard pages,
+// so the OS can merge the reservations of many files into a single mapping.
+// nothing can write past the end of a segment: the lexer segments are sized for one token,
+// value, line and string byte per byte of code, and relexing never grows the code past that size.
+// the syntax tree segments are checked on every node allocation, see TekGenSyn_alloc_node.
+#if TEK_HUGE_PAGES
+#define _tek_mem_segs_flags_compiler (TekMemSegsFlags_guard_pages | TekMemSegsFlags_huge_pages)
+#define _tek_mem_segs_flags_file TekMemSegsFlags_huge_pages
+#else
+#define _tek_mem_segs_flags_compiler TekMemSegsFlags_guard_pages
+#define _tek_mem_segs_flags_file 0
+#endif
+#define _tek_mem_segs_flags_lib TekMemSegsFlags_guard_pages
+
+//
+// the number of bytes at the start of each file segment that may have been written to.
+// the string_buf is decommitted once the file has been lexed, see TekMemSegFile_last_job_types,
+// and nothing writes to the syntax_tree_array_node_indices yet.
+static void _TekFile_segment_used_sizes(TekFile* file, uintptr_t* used_sizes_out) {
+	used_sizes_out[TekMemSegFile_token_locs] = file->tokens_count * sizeof(TekTokenLocCompact);
+	used_sizes_out[TekMemSegFile_tokens] = file->tokens_count * sizeof(TekToken);
+	used_sizes_out[TekMemSegFile_token_values] = file->token_values_count * sizeof(TekValue);
+	used_sizes_out[TekMemSegFile_bracket_matches] = file->tokens_count * sizeof(uint32_t);
+	used_sizes_out[TekMemSegFile_string_buf] = 0;
+	used_sizes_out[TekMemSegFile_line_code_start_indices] = file->lines_count * sizeof(uintptr_t);
+	used_sizes_out[TekMemSegFile_syntax_tree_nodes] = file->syntax_tree_nodes_count * sizeof(TekSynNode);
+	used_sizes_out[TekMemSegFile_syntax_tree_array_node_indices] = 0;
+	used_sizes_out[TekMemSegFile_code_buf] = file->code == TekFile_code_buf(file) ? file->size : 0;
+}
+
+static void _TekLib_segment_used_sizes(TekLib* lib, uintptr_t* used_sizes_out) {
+	used_sizes_out[TekMemSegLib_files] = lib->files_count * sizeof(TekFileId);
+	used_sizes_out[TekMemSegLib_dependers] = lib->dependers_count * sizeof(TekLibId);
+	used_sizes_out[TekMemSegLib_dependencies] = lib->dependencies_count * sizeof(TekLibId);
+}
+
+//
+// only fills out the first TekMemSegCompiler_RESET_COUNT segments,
+// the segments after that are not written to by a compile.
+static void _TekCompiler_segment_used_sizes(TekCompiler* c, uintptr_t* used_sizes_out) {
+	used_sizes_out[TekMemSegCompiler_compiler_struct] = sizeof(TekCompiler);
+	used_sizes_out[TekMemSegCompiler_workers] = c->workers_count * sizeof(TekWorker);
+	used_sizes_out[TekMemSegCompiler_libs] = atomic_load(&c->libs_count) * sizeof(TekLib);
+	used_sizes_out[TekMemSegCompiler_file_paths] = atomic_load(&c->files_count) * sizeof(TekStrId);
+	used_sizes_out[TekMemSegCompiler_files] = atomic_load(&c->files_count) * sizeof(TekFile);
+	used_sizes_out[TekMemSegCompiler_strtab_hashes] = atomic_load(&c->strtab_entries_count) * sizeof(TekHash);
+	used_sizes_out[TekMemSegCompiler_strtab_entries] = atomic_load(&c->strtab_entries_count) * sizeof(TekStrEntry);
+	used_sizes_out[TekMemSegCompiler_strtab_strings] = atomic_load(&c->strtab_strings_size);
+	used_sizes_out[TekMemSegCompiler_jobs] = atomic_load(&c->jobs_count) * sizeof(TekJob);
+	used_sizes_out[TekMemSegCompiler_errors] = atomic_load(&c->errors_count) * sizeof(TekError);
+	used_sizes_out[TekMemSegCompiler_overlay_path_str_ids] = c->overlays_count * sizeof(TekStrId);
+}
+
+//
+// releases the segment groups waiting in the pool.
+// this can race against takers, so each group is popped off before it is released.
+// @return: the number of segment groups that were released.
+static uint32_t _TekCompiler_seg_group_pool_trim(TekCompiler* c) {
+	TekSegGroupPool* pool = TekCompiler_seg_group_pool(c);
+	uint32_t released_count = 0;
+
+	uint32_t expected = atomic_load(&pool->libs_count);
+	while (expected) {
+		if (atomic_compare_exchange_weak(&pool->libs_count, &expected, expected - 1)) {
+			tek_mem_segs_release(TekMemSegLib_COUNT, TekMemSegLib_sizes, _tek_mem_segs_flags_lib, pool->libs[expected - 1]);
+			released_count += 1;
+			expected -= 1;
+		}
+	}
+
+	for (uint8_t seg_class = 0; seg_class < TekFileSegClass_COUNT; seg_class += 1) {
+		_Atomic uint32_t* count = &pool->files_counts[seg_class];
+		expected = atomic_load(count);
+		if (expected == 0) continue;
+
+		uintptr_t sizes[TekMemSegFile_COUNT];
+		TekFile_segment_sizes(seg_class, sizes);
+		uintptr_t total_size = tek_mem_segs_layout(TekMemSegFile_COUNT, sizes, _tek_mem_segs_flags_file, NULL, NULL);
+		while (expected) {
+			if (atomic_compare_exchange_weak(count, &expected, expected - 1)) {
+				tek_virt_mem_release(pool->files[seg_class][expected - 1], total_size);
+				released_count += 1;
+				expected -= 1;
+			}
+		}
+	}
+
+	return released_count;
+}
+
+//
+// gives back the memory of a file that no job will touch again in this compile.
+// the segments that TekMemSegFile_last_job_types keeps until the next compile are decommitted past
+// their used sizes and the rest are decommitted whole. a memory mapped file's code is decommitted too,
+// it is faulted back in from the page cache if an error message needs it.
+static void _TekFile_trim(TekFile* file) {
+	uintptr_t page_size = tek_virt_mem_page_size();
+	uintptr_t used_sizes[TekMemSegFile_COUNT];
+	_TekFile_segment_used_sizes(file, used_sizes);
+
+	for (uint32_t i = 0; i < TekMemSegFile_COUNT; i += 1) {
+		uintptr_t keep_size = 0;
+		if (TekMemSegFile_last_job_types[i] == TekJobType_COUNT) {
+			keep_size = (uintptr_t)tek_ptr_round_up_align((void*)used_sizes[i], page_size);
+		}
+
+		if (keep_size < file->segment_sizes[i]) {
+			tek_virt_mem_decommit(tek_ptr_add(file->segments[i], keep_size), file->segment_sizes[i] - keep_size);
 		}
+	}
+
+	if (file->flags & TekFileFlags_is_mapped) {
+		tek_virt_mem_decommit(file->code, file->size);
+	}
+}
+
+//
+// trims every file that has finished since the last time this was called.
+// @return: the number of files that were trimmed.
+static uint32_t _TekCompiler_finished_files_trim(TekCompiler* c) {
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	uint32_t trimmed_count = 0;
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
 
 		//
-		// the guard_page sit right after the segment
-		void* guard_page = tek_ptr_add(segments_in_out[i], memsegs_sizes[i]);
-		if (!tek_virt_mem_release(guard_page, page_size)) {
-			return tek_virt_mem_get_last_error();
+		// only one worker gets to trim each file.
+		TekFileMemState expected = TekFileMemState_finished;
+		if (atomic_compare_exchange_strong(&file->mem_state, &expected, TekFileMemState_trimmed)) {
+			_TekFile_trim(file);
+			trimmed_count += 1;
 		}
+	}
 
-		segments_in_out[i] = NULL;
+	return trimmed_count;
+}
+
+//
+// the workers' out of memory handler when there is a TekCompileArgs.mem_limit.
+// the pooled segment groups are not needed to finish the compile, so their address space is given back first.
+// then the memory of the files that every job has finished with is given back.
+// the allocation is tried again each time something was given back, otherwise it fails.
+static TekBool _TekCompiler_out_of_mem_handler(void* data, uintptr_t size, uint32_t fail_num) {
+	//
+	// the allocation is tried again for as long as something is given back, however big it is or however many times it failed.
+	(void)size;
+	(void)fail_num;
+	TekCompiler* c = data;
+	if (_TekCompiler_seg_group_pool_trim(c) > 0) {
+		return tek_true;
 	}
 
-	return 0;
+	return _TekCompiler_finished_files_trim(c) > 0;
+}
+
+static TekVirtMemError _TekCompiler_file_segs_take(TekCompiler* c, TekFile* file, uint8_t seg_class) {
+	file->seg_class = seg_class;
+	TekFile_segment_sizes(seg_class, file->segment_sizes);
+
+	//
+	// try to take a group from the pool first.
+	// nothing is given back to the pool while the workers are running, so this
+	// only has to race against other takers.
+	TekSegGroupPool* pool = TekCompiler_seg_group_pool(c);
+	_Atomic uint32_t* count = &pool->files_counts[seg_class];
+	uint32_t expected = atomic_load(count);
+	while (expected) {
+		if (atomic_compare_exchange_weak(count, &expected, expected - 1)) {
+			void* mem = pool->files[seg_class][expected - 1];
+			tek_mem_segs_layout(TekMemSegFile_COUNT, file->segment_sizes, _tek_mem_segs_flags_file, mem, file->segments);
+			return 0;
+		}
+	}
+
+	//
+	// reserve a new group, giving the out of memory handler a chance to make room if that fails.
+	uint32_t fail_num = 1;
+	while (1) {
+		TekVirtMemError res = tek_mem_segs_reserve(TekMemSegFile_COUNT, file->segment_sizes, _tek_mem_segs_flags_file, file->segments);
+		if (res == 0 || !tek_out_of_mem_handler.fn) {
+			return res;
+		}
+
+		uintptr_t total_size = tek_mem_segs_layout(TekMemSegFile_COUNT, file->segment_sizes, _tek_mem_segs_flags_file, NULL, NULL);
+		if (!tek_out_of_mem_handler.fn(tek_out_of_mem_handler.data, total_size, fail_num)) {
+			return res;
+		}
+		fail_num += 1;
+	}
+}
+
+static void _TekCompiler_file_segs_recycle(TekCompiler* c, TekFile* file) {
+	uintptr_t total_size = tek_mem_segs_layout(TekMemSegFile_COUNT, file->segment_sizes, _tek_mem_segs_flags_file, NULL, NULL);
+	uintptr_t used_sizes[TekMemSegFile_COUNT];
+	_TekFile_segment_used_sizes(file, used_sizes);
+
+	//
+	// decommit only the parts of the segments that have been used.
+	// nothing is kept warm, as the pool can hold far more groups than will be taken again soon.
+	// if that fails or the pool is full, just release them instead.
+	TekSegGroupPool* pool = TekCompiler_seg_group_pool(c);
+	uint32_t count = atomic_load(&pool->files_counts[file->seg_class]);
+	if (count < tek_seg_group_pool_cap && tek_mem_segs_reset(TekMemSegFile_COUNT, used_sizes, 0, file->segments) == 0) {
+		pool->files[file->seg_class][count] = file->segments[0];
+		atomic_store(&pool->files_counts[file->seg_class], count + 1);
+	} else {
+		tek_virt_mem_release(file->segments[0], total_size);
+	}
+}
+
+static TekVirtMemError _TekCompiler_lib_segs_take(TekCompiler* c, TekLib* lib) {
+	TekSegGroupPool* pool = TekCompiler_seg_group_pool(c);
+	uint32_t expected = atomic_load(&pool->libs_count);
+	while (expected) {
+		if (atomic_compare_exchange_weak(&pool->libs_count, &expected, expected - 1)) {
+			tek_copy_elmts(lib->segments, pool->libs[expected - 1], TekMemSegLib_COUNT);
+			return 0;
+		}
+	}
+
+	return tek_mem_segs_reserve(TekMemSegLib_COUNT, TekMemSegLib_sizes, _tek_mem_segs_flags_lib, lib->segments);
+}
+
+static void _TekCompiler_lib_segs_recycle(TekCompiler* c, TekLib* lib) {
+	TekSegGroupPool* pool = TekCompiler_seg_group_pool(c);
+	uint32_t count = atomic_load(&pool->libs_count);
+	uintptr_t used_sizes[TekMemSegLib_COUNT];
+	_TekLib_segment_used_sizes(lib, used_sizes);
+	if (count < tek_seg_group_pool_cap && tek_mem_segs_reset(TekMemSegLib_COUNT, used_sizes, 0, lib->segments) == 0) {
+		tek_copy_elmts(pool->libs[count], lib->segments, TekMemSegLib_COUNT);
+		atomic_store(&pool->libs_count, count + 1);
+	} else {
+		tek_mem_segs_release(TekMemSegLib_COUNT, TekMemSegLib_sizes, _tek_mem_segs_flags_lib, lib->segments);
+	}
 }
 
 TekJob* TekCompiler_job_queue(TekCompiler* c, TekJobType type) {
@@ -332,7 +813,7 @@ TekJob* TekCompiler_job_queue(TekCompiler* c, TekJobType type) {
 
 TekCompiler* TekCompiler_init() {
 	void* segments[TekMemSegCompiler_COUNT];
-	TekVirtMemError res = tek_mem_segs_reserve(TekMemSegCompiler_COUNT, TekMemSegCompiler_sizes, segments);
+	TekVirtMemError res = tek_mem_segs_reserve(TekMemSegCompiler_COUNT, TekMemSegCompiler_sizes, _tek_mem_segs_flags_compiler, segments);
 	if (res) {
 		return NULL;
 	}
@@ -342,7 +823,15 @@ TekCompiler* TekCompiler_init() {
 }
 
 void TekCompiler_deinit(TekCompiler* c) {
-	tek_mem_segs_release(TekMemSegCompiler_COUNT, TekMemSegCompiler_sizes, c->segments);
+	//
+	// release the segment groups that are waiting in the pool
+	_TekCompiler_seg_group_pool_trim(c);
+
+	//
+	// copy out the segment pointers first, as the compiler struct lives in the first segment.
+	void* segments[TekMemSegCompiler_COUNT];
+	tek_copy_elmts(segments, c->segments, TekMemSegCompiler_COUNT);
+	tek_mem_segs_release(TekMemSegCompiler_COUNT, TekMemSegCompiler_sizes, _tek_mem_segs_flags_compiler, segments);
 }
 
 TekStrId TekCompiler_strtab_get_or_insert(TekCompiler* c, char* str, uint32_t str_len) {
@@ -368,12 +857,14 @@ TekStrId TekCompiler_strtab_get_or_insert(TekCompiler* c, char* str, uint32_t st
 				str_id = end_idx + 1;
 				atomic_fetch_add(&c->strtab_entries_count, 1);
 
-				// add the enough room for the size of the string to sit infront of the string.
+				// add the enough room for the size of the string to sit infront of the string
+				// and a null terminator after it, so the value can be used as a C string like the import paths are.
 				// and make sure the next string entry can be aligned correctly by rounding up.
-				uintptr_t rounded_len = (uintptr_t)tek_ptr_round_up_align((void*)((uintptr_t)str_len + sizeof(uint32_t)), alignof(uint32_t));
+				uintptr_t rounded_len = (uintptr_t)tek_ptr_round_up_align((void*)((uintptr_t)str_len + sizeof(uint32_t) + 1), alignof(uint32_t));
 				TekStrEntry entry = &strings[atomic_fetch_add(&c->strtab_strings_size, rounded_len)];
 				*(uint32_t*)entry = str_len;
 				tek_copy_bytes(tek_ptr_add(entry, sizeof(uint32_t)), str, str_len);
+				entry[sizeof(uint32_t) + str_len] = '\0';
 
 				// now store the entry in the entries array.
 				atomic_store(&entries[str_id - 1], entry);
@@ -423,11 +914,14 @@ TekFileId TekCompiler_file_get_or_create(TekCompiler* c, char* file_path, TekFil
 	char path[PATH_MAX];
 	int res = tek_file_path_normalize_resolve(file_path, path);
 	if (res != 0) {
-		TekError* e = TekCompiler_error_add(c, TekErrorKind_invalid_file_path);
-		e->args[0].file_path = file_path;
-		e->args[1].errnum = res;
-		TekCompiler_signal_stop(c);
-		return 0;
+		//
+		// the path may not exist on disk but it can still be the path of an overlay.
+		// so use the path as is and see if one matches below.
+		uint32_t file_path_len = strlen(file_path);
+		if (c->overlays_count == 0 || file_path_len >= PATH_MAX) {
+			goto INVALID_PATH;
+		}
+		tek_copy_bytes(path, file_path, file_path_len + 1);
 	}
 
 	//
@@ -435,6 +929,14 @@ TekFileId TekCompiler_file_get_or_create(TekCompiler* c, char* file_path, TekFil
 	// strlen + 1 to add the null terminator.
 	TekStrId path_str_id = TekCompiler_strtab_get_or_insert(c, path, strlen(path) + 1);
 
+	//
+	// the overlay paths are interned at the start of the compile,
+	// so we can find a matching overlay by just comparing string ids.
+	uint32_t overlay_id = tek_atomic_find_str_id(TekCompiler_overlay_path_str_ids(c), path_str_id, 0, c->overlays_count);
+	if (res != 0 && overlay_id == 0) {
+		goto INVALID_PATH;
+	}
+
 	//
 	// try to find a file with the same path and return that.
 	// or create a new file.
@@ -479,29 +981,81 @@ TekFileId TekCompiler_file_get_or_create(TekCompiler* c, char* file_path, TekFil
 	// this is a new file so set it up and queue it for lexing
 	//
 	TekFile* file = &files[file_id - 1];
-	TekVirtMemError virt_mem_res = tek_mem_segs_reserve(TekMemSegFile_COUNT, TekMemSegFile_sizes, file->segments);
-	if (virt_mem_res) {
-		TekError* e = TekCompiler_error_add(c, TekErrorKind_virt_mem);
-		e->args[0].virt_mem_error = virt_mem_res;
-		return 0;
+	file->id = file_id;
+	file->path_str_id = path_str_id;
+
+	//
+	// overlays point straight at the caller's code.
+	// small files are read straight into the code buffer segment, this costs less than
+	// setting up a mapping and then taking a page fault for each page of the file.
+	// larger files are memory mapped, pre-faulting the whole file up front unless it is
+	// big enough that we would rather start lexing while the OS reads the rest in.
+	TekBool read_into_code_buf = tek_false;
+	if (overlay_id) {
+		TekFileOverlay* overlay = &c->compile_args->overlays[overlay_id - 1];
+		file->code = overlay->code;
+		file->size = overlay->size;
+		file->flags |= TekFileFlags_is_overlay;
+	} else {
+		res = tek_file_size(path, &file->size);
+		if (res == 0 && file->size <= tek_file_code_read_max_size) {
+			read_into_code_buf = tek_true;
+		} else {
+			TekVirtMemMapAdvice advice = file->size <= tek_file_code_populate_max_size
+				? TekVirtMemMapAdvice_populate
+				: TekVirtMemMapAdvice_sequential;
+
+			file->code = tek_virt_mem_map_file(path, TekVirtMemProtection_read, advice, &file->size, &file->handle);
+			if (file->code == NULL) {
+				TekError* e = TekCompiler_error_add(c, TekErrorKind_lexer_file_read_failed);
+				e->args[0].file_id = file_id;
+				e->args[1].virt_mem_error = tek_virt_mem_get_last_error();
+				return 0;
+			}
+			file->flags |= TekFileFlags_is_mapped;
+		}
 	}
 
 	//
-	// memory map the file into the address space
-	file->code = tek_virt_mem_map_file(path, TekVirtMemProtection_read, &file->size, &file->handle);
-	if (file->code == NULL) {
+	// the token locations store code indices as 32 bit integers.
+	if (file->size > UINT32_MAX) {
 		TekError* e = TekCompiler_error_add(c, TekErrorKind_lexer_file_read_failed);
 		e->args[0].file_id = file_id;
-		e->args[1].virt_mem_error = tek_virt_mem_get_last_error();
+		e->args[1].virt_mem_error = EFBIG;
 		return 0;
 	}
 
-	file->id = file_id;
-	file->path_str_id = path_str_id;
+	//
+	// the segments are sized from the code size, so a file only reserves
+	// about as much address space as it can possibly use.
+	TekVirtMemError virt_mem_res = _TekCompiler_file_segs_take(c, file, TekFileSegClass_from_code_size(file->size));
+	if (virt_mem_res) {
+		TekError* e = TekCompiler_error_add(c, TekErrorKind_virt_mem);
+		e->args[0].virt_mem_error = virt_mem_res;
+		return 0;
+	}
+
+	if (read_into_code_buf) {
+		res = tek_file_read_into(path, TekFile_code_buf(file), file->size);
+		if (res) {
+			TekError* e = TekCompiler_error_add(c, TekErrorKind_lexer_file_read_failed);
+			e->args[0].file_id = file_id;
+			e->args[1].virt_mem_error = res;
+			return 0;
+		}
+		file->code = TekFile_code_buf(file);
+	}
 
 	TekJob* job = TekCompiler_job_queue(c, TekJobType_lex_file);
 	job->file_id = file_id;
 	return file_id;
+
+INVALID_PATH: {}
+	TekError* e = TekCompiler_error_add(c, TekErrorKind_invalid_file_path);
+	e->args[0].file_path = file_path;
+	e->args[1].errnum = res;
+	TekCompiler_signal_stop(c);
+	return 0;
 }
 
 TekFile* TekCompiler_file_get(TekCompiler* c, TekFileId file_id) {
@@ -520,7 +1074,7 @@ TekLibId TekCompiler_lib_create(TekCompiler* c, char* root_src_file_path) {
 
 	//
 	// allocate the memory segments for the lib structure
-	TekVirtMemError res = tek_mem_segs_reserve(TekMemSegLib_COUNT, TekMemSegLib_sizes, lib->segments);
+	TekVirtMemError res = _TekCompiler_lib_segs_take(c, lib);
 	if (res) {
 		TekError* e = TekCompiler_error_add(c, TekErrorKind_virt_mem);
 		e->args[0].virt_mem_error = res;
@@ -552,29 +1106,43 @@ TekCompilerError TekCompiler_compile_start(TekCompiler* c, uint16_t workers_coun
 	}
 
 	//
-	// release all of the memory segments of the libraries and files
+	// give the memory segments of the libraries and files from the last compile back to the pool
+	// so they can be reused, and unmap any source files that were mapped.
 	//
 	{
 		TekLib* libs = TekCompiler_libs(c);
 		uint32_t libs_count = atomic_load(&c->libs_count);
 		for (uint32_t i = 0; i < libs_count; i += 1) {
-			if (libs->segments[0] == NULL) break;
-			tek_mem_segs_release(TekMemSegLib_COUNT, TekMemSegLib_sizes, libs->segments);
+			TekLib* lib = &libs[i];
+			if (lib->segments[0] == NULL) continue;
+			_TekCompiler_lib_segs_recycle(c, lib);
 		}
 
 		TekFile* files = TekCompiler_files(c);
 		uint32_t files_count = atomic_load(&c->files_count);
 		for (uint32_t i = 0; i < files_count; i += 1) {
-			if (files->segments[0] == NULL) break;
-			tek_mem_segs_release(TekMemSegFile_COUNT, TekMemSegFile_sizes, files->segments);
+			TekFile* file = &files[i];
+			if (file->flags & TekFileFlags_is_mapped) {
+				tek_virt_mem_release(file->code, file->size);
+				tek_virt_mem_map_file_close(file->handle);
+			}
+			if (file->segments[0] == NULL) continue;
+			_TekCompiler_file_segs_recycle(c, file);
 		}
 	}
 
+	//
+	// work out how much of each compiler segment the last compile used, from the counts.
+	// nothing is ever written past these, so only these parts need to be zeroed.
+	uintptr_t used_sizes[TekMemSegCompiler_RESET_COUNT];
+	_TekCompiler_segment_used_sizes(c, used_sizes);
+
 	//
 	// copy out the segment pointers and then zero the compiler segments.
+	// the segments after TekMemSegCompiler_RESET_COUNT are kept as they are.
 	void* segments[TekMemSegCompiler_COUNT];
 	tek_copy_elmts(segments, c->segments, TekMemSegCompiler_COUNT);
-	tek_mem_segs_reset(TekMemSegCompiler_COUNT, TekMemSegCompiler_sizes, segments);
+	tek_mem_segs_reset(TekMemSegCompiler_RESET_COUNT, used_sizes, tek_mem_segs_warm_size, segments);
 
 	//
 	// copy the segment pointers back and initialize the data.
@@ -583,6 +1151,24 @@ TekCompilerError TekCompiler_compile_start(TekCompiler* c, uint16_t workers_coun
 	c->compile_args = args;
 	c->workers_count = workers_count;
 
+	//
+	// resolve and intern the overlay paths so files can be matched to them by string id.
+	// paths that do not exist on disk are used as is.
+	// this is done before the workers start, so nothing else is using the string table.
+	tek_assert(
+		args->overlays_count <= TekMemSegCompiler_sizes[TekMemSegCompiler_overlay_path_str_ids] / sizeof(TekStrId),
+		"too many file overlays '%u'", args->overlays_count);
+	_Atomic TekStrId* overlay_path_str_ids = TekCompiler_overlay_path_str_ids(c);
+	for (uint32_t i = 0; i < args->overlays_count; i += 1) {
+		char path_buf[PATH_MAX];
+		char* path = args->overlays[i].path;
+		if (tek_file_path_normalize_resolve(path, path_buf) == 0) {
+			path = path_buf;
+		}
+		overlay_path_str_ids[i] = TekCompiler_strtab_get_or_insert(c, path, strlen(path) + 1);
+	}
+	c->overlays_count = args->overlays_count;
+
 	// the last worker will unlock this mutex at the end of _TekWorker_main
 	TekMtx_lock(&c->wait_mtx);
 
@@ -1154,10 +1740,90 @@ void TekCompiler_debug_syntax_tree(TekCompiler* c) {
 	TekStk_deinit(&output);
 }
 
+static void _TekCompiler_mem_report_row(TekStk(char)* string_out, char* group_name, char* seg_name, uintptr_t reserved_size, uintptr_t used_size, uintptr_t resident_size) {
+	TekStk_push_str_fmt(string_out, "%-8s %-30s %14zu %14zu %14zu\n", group_name, seg_name, reserved_size, used_size, resident_size);
+}
+
+void TekCompiler_mem_report(TekCompiler* c, TekStk(char)* string_out) {
+	TekStk_push_str_fmt(string_out, "%-8s %-30s %14s %14s %14s\n", "group", "segment", "reserved", "high-water", "resident");
+
+	//
+	// the high-water marks come from the counts, so they are how far into each segment we have written.
+	// the resident sizes come from asking the OS, which catches anything written past them
+	// and shows what has already been decommitted.
+	// the seg_group_pool does not keep a count, so its high-water mark is the resident size.
+	uintptr_t used_sizes[TekMemSegCompiler_COUNT];
+	_TekCompiler_segment_used_sizes(c, used_sizes);
+	for (uint32_t seg = 0; seg < TekMemSegCompiler_COUNT; seg += 1) {
+		uintptr_t resident_size = tek_virt_mem_resident_size(c->segments[seg], TekMemSegCompiler_sizes[seg]);
+		uintptr_t used_size = seg < TekMemSegCompiler_RESET_COUNT ? used_sizes[seg] : resident_size;
+		_TekCompiler_mem_report_row(string_out, "compiler", TekMemSegCompiler_strings[seg], TekMemSegCompiler_sizes[seg], used_size, resident_size);
+	}
+
+	uintptr_t lib_reserved_sizes[TekMemSegLib_COUNT] = {0};
+	uintptr_t lib_used_sizes[TekMemSegLib_COUNT] = {0};
+	uintptr_t lib_resident_sizes[TekMemSegLib_COUNT] = {0};
+	TekLib* libs = TekCompiler_libs(c);
+	uint32_t libs_count = atomic_load(&c->libs_count);
+	for (uint32_t i = 0; i < libs_count; i += 1) {
+		TekLib* lib = &libs[i];
+		if (lib->segments[0] == NULL) continue;
+
+		_TekLib_segment_used_sizes(lib, used_sizes);
+		for (uint32_t seg = 0; seg < TekMemSegLib_COUNT; seg += 1) {
+			lib_reserved_sizes[seg] += TekMemSegLib_sizes[seg];
+			lib_used_sizes[seg] += used_sizes[seg];
+			lib_resident_sizes[seg] += tek_virt_mem_resident_size(lib->segments[seg], TekMemSegLib_sizes[seg]);
+		}
+	}
+	for (uint32_t seg = 0; seg < TekMemSegLib_COUNT; seg += 1) {
+		_TekCompiler_mem_report_row(string_out, "lib", TekMemSegLib_strings[seg], lib_reserved_sizes[seg], lib_used_sizes[seg], lib_resident_sizes[seg]);
+	}
+
+	uintptr_t file_reserved_sizes[TekMemSegFile_COUNT] = {0};
+	uintptr_t file_used_sizes[TekMemSegFile_COUNT] = {0};
+	uintptr_t file_resident_sizes[TekMemSegFile_COUNT] = {0};
+	uintptr_t mapped_code_size = 0;
+	uintptr_t mapped_code_resident_size = 0;
+	uintptr_t page_size = tek_virt_mem_page_size();
+	TekFile* files = TekCompiler_files(c);
+	uint32_t files_count = atomic_load(&c->files_count);
+	for (uint32_t i = 0; i < files_count; i += 1) {
+		TekFile* file = &files[i];
+		if (file->flags & TekFileFlags_is_mapped) {
+			uintptr_t size = (uintptr_t)tek_ptr_round_up_align((void*)file->size, page_size);
+			mapped_code_size += file->size;
+			mapped_code_resident_size += tek_virt_mem_resident_size(file->code, size);
+		}
+		if (file->segments[0] == NULL) continue;
+
+		_TekFile_segment_used_sizes(file, used_sizes);
+		for (uint32_t seg = 0; seg < TekMemSegFile_COUNT; seg += 1) {
+			file_reserved_sizes[seg] += file->segment_sizes[seg];
+			file_used_sizes[seg] += used_sizes[seg];
+			file_resident_sizes[seg] += tek_virt_mem_resident_size(file->segments[seg], file->segment_sizes[seg]);
+		}
+	}
+	for (uint32_t seg = 0; seg < TekMemSegFile_COUNT; seg += 1) {
+		_TekCompiler_mem_report_row(string_out, "file", TekMemSegFile_strings[seg], file_reserved_sizes[seg], file_used_sizes[seg], file_resident_sizes[seg]);
+	}
+	_TekCompiler_mem_report_row(string_out, "file", "mapped_code", mapped_code_size, mapped_code_size, mapped_code_resident_size);
+
+	TekStk_push_str_fmt(string_out, "libs: %u, files: %u, peak resident: %zu\n", libs_count, files_count, tek_process_peak_resident_size());
+}
+
 TekCompilerError TekCompiler_compile_wait(TekCompiler* c) {
 	TekMtx_lock(&c->wait_mtx);
 	TekMtx_unlock(&c->wait_mtx);
 
+	//
+	// the last worker still has to clear the running flag after unlocking the mutex.
+	// so join them all, to make sure none are touching the compiler when the next compile starts.
+	TekWorker* workers = TekCompiler_workers(c);
+	for (uint32_t i = 0; i < c->workers_count; i += 1) {
+		thrd_join(workers[i].thread, NULL);
+	}
+
 	if (TekCompiler_has_errors(c)) {
 		return TekCompilerError_compile_error;
 	} else {
@@ -1197,6 +1863,7 @@ static char* TekErrorKind_message[TekErrorKind_COUNT] = {
 	[TekErrorKind_lexer_unsupported_token] = "unsupported token",
 	[TekErrorKind_lexer_expected_a_compile_time_token] = "expected a compile time token",
 	[TekErrorKind_lexer_unclosed_block_comment] = "unclosed block comment",
+	[TekErrorKind_lexer_invalid_utf8] = "invalid UTF-8, source files must be UTF-8 encoded",
 	[TekErrorKind_lexer_invalid_string_ascii_esc_char_code_fmt] = "invalid string ascii escape character code format",
 	[TekErrorKind_lexer_invalid_string_esc_sequence] = "invalid string escape sequence",
 	[TekErrorKind_lexer_invalid_close_bracket] = "invalid close bracket",
@@ -1233,6 +1900,7 @@ static char* TekErrorKind_message[TekErrorKind_COUNT] = {
 	[TekErrorKind_gen_syn_expr_for_expected_stmt_block] = "expected a '{' here to follow the iterator of the for expression to define the loop block",
 	[TekErrorKind_gen_syn_expr_for_expected_in_keyword] = "expected 'in' keyword here to follow the variable declartion of the for loop expression",
 	[TekErrorKind_gen_syn_stmt_only_allow_var_decl] = "inside statement blocks, we can only have 'var' declartions",
+	[TekErrorKind_gen_syn_file_has_too_many_nodes] = "this file generates more syntax tree nodes than were reserved for it, try splitting it up into smaller files",
 };
 
 static char* TekErrorKind_double_info_lines[TekErrorKind_COUNT][2] = {
@@ -1271,11 +1939,10 @@ void TekCompiler_error_string_code_span(TekStk(char)* string_out, char* code, ui
 
 void TekCompiler_error_string_code(TekCompiler* c, TekStk(char)* string_out, TekFile* file, uint32_t line, uint32_t column, uint32_t code_idx_start, uint32_t code_idx_end, TekBool use_ascii_colors) {
 	char* code = file->code;
-	uintptr_t* line_code_start_indices = TekFile_line_code_start_indices(file);
-	uint32_t code_idx_prev_line_start = line_code_start_indices[line == 1 ? 0 : line - 2];
-	uint32_t code_idx_line_start = line_code_start_indices[line - 1];
-	uint32_t code_idx_next_line_start = line_code_start_indices[line >= file->lines_count ? file->lines_count - 1 : line];
-	uint32_t code_idx_next_next_line_start = line_code_start_indices[line + 1 >= file->lines_count ? file->lines_count - 1 : line + 1];
+	uint32_t code_idx_prev_line_start = TekFile_line_code_start_idx(file, line == 1 ? 0 : line - 2);
+	uint32_t code_idx_line_start = TekFile_line_code_start_idx(file, line - 1);
+	uint32_t code_idx_next_line_start = TekFile_line_code_start_idx(file, line >= file->lines_count ? file->lines_count - 1 : line);
+	uint32_t code_idx_next_next_line_start = TekFile_line_code_start_idx(file, line + 1 >= file->lines_count ? file->lines_count - 1 : line + 1);
 
 	char* path = TekStrEntry_value(TekCompiler_strtab_get_entry(c, file->path_str_id));
 	char* fmt = use_ascii_colors
@@ -1367,10 +2034,10 @@ void TekCompiler_error_string_virt_mem(TekCompiler* c, TekStk(char)* string_out,
 
 void TekCompiler_error_string_single(TekCompiler* c, TekStk(char)* string_out, TekBool use_ascii_colors, TekError* e) {
 	TekFile* file = TekCompiler_file_get(c, e->args[0].file_id);
-	TekTokenLoc* loc = &TekFile_token_locs(file)[e->args[0].token_idx];
+	TekTokenLoc loc = TekFile_token_loc(file, e->args[0].token_idx);
 
 	TekCompiler_error_string_error_line(string_out, e->kind, use_ascii_colors);
-	TekCompiler_error_string_code(c, string_out, file, loc->line, loc->column, loc->code_idx_start, loc->code_idx_end, use_ascii_colors);
+	TekCompiler_error_string_code(c, string_out, file, loc.line, loc.column, loc.code_idx_start, loc.code_idx_end, use_ascii_colors);
 }
 
 void TekCompiler_error_string_double(TekCompiler* c, TekStk(char)* string_out, TekBool use_ascii_colors, TekError* e) {
@@ -1378,14 +2045,14 @@ void TekCompiler_error_string_double(TekCompiler* c, TekStk(char)* string_out, T
 	char** info_lines = TekErrorKind_double_info_lines[e->kind];
 
 	TekFile* file = TekCompiler_file_get(c, e->args[0].file_id);
-	TekTokenLoc* loc = &TekFile_token_locs(file)[e->args[0].token_idx];
+	TekTokenLoc loc = TekFile_token_loc(file, e->args[0].token_idx);
 	TekCompiler_error_string_info_line(string_out, info_lines[0], use_ascii_colors);
-	TekCompiler_error_string_code(c, string_out, file, loc->line, loc->column, loc->code_idx_start, loc->code_idx_end, use_ascii_colors);
+	TekCompiler_error_string_code(c, string_out, file, loc.line, loc.column, loc.code_idx_start, loc.code_idx_end, use_ascii_colors);
 
 	file = TekCompiler_file_get(c, e->args[1].file_id);
-	loc = &TekFile_token_locs(file)[e->args[1].token_idx];
+	loc = TekFile_token_loc(file, e->args[1].token_idx);
 	TekCompiler_error_string_info_line(string_out, info_lines[1], use_ascii_colors);
-	TekCompiler_error_string_code(c, string_out, file, loc->line, loc->column, loc->code_idx_start, loc->code_idx_end, use_ascii_colors);
+	TekCompiler_error_string_code(c, string_out, file, loc.line, loc.column, loc.code_idx_start, loc.code_idx_end, use_ascii_colors);
 }
 
 void TekCompiler_errors_string(TekCompiler* c, TekStk(char)* string_out, TekBool use_ascii_colors) {
@@ -1420,6 +2087,7 @@ void TekCompiler_errors_string(TekCompiler* c, TekStk(char)* string_out, TekBool
 			case TekErrorKind_lexer_unsupported_token:
 			case TekErrorKind_lexer_expected_a_compile_time_token:
 			case TekErrorKind_lexer_unclosed_block_comment:
+			case TekErrorKind_lexer_invalid_utf8:
 			case TekErrorKind_lexer_invalid_string_ascii_esc_char_code_fmt:
 			case TekErrorKind_lexer_invalid_string_esc_sequence:
 			case TekErrorKind_gen_syn_mod_must_have_impl:
@@ -1453,6 +2121,7 @@ void TekCompiler_errors_string(TekCompiler* c, TekStk(char)* string_out, TekBool
 			case TekErrorKind_gen_syn_expr_for_expected_stmt_block:
 			case TekErrorKind_gen_syn_expr_for_expected_in_keyword:
 			case TekErrorKind_gen_syn_stmt_only_allow_var_decl:
+			case TekErrorKind_gen_syn_file_has_too_many_nodes:
 				TekCompiler_error_string_single(c, string_out, use_ascii_colors, e);
 				break;
 			case TekErrorKind_lexer_invalid_close_bracket:
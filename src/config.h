@@ -4,14 +4,72 @@
 #define TEK_DEBUG_ASSERTIONS 0
 #define TEK_HASH_64 0
 
+//
+// opt-in to backing the large compiler and file segments with transparent huge pages.
+// this cuts down on TLB misses for big projects at the cost of more memory for small ones.
+#ifndef TEK_HUGE_PAGES
+#define TEK_HUGE_PAGES 0
+#endif
+#define tek_huge_page_size 0x200000 // 2MB
+
+//
+// the lexer skips over whitespace and comments with SSE2 or AVX2, when the compiler targets them.
+// set this to 0 to always use the scalar loops.
+#ifndef TEK_LEXER_SIMD
+#define TEK_LEXER_SIMD 1
+#endif
+
+//
+// the lexer checks that the whole file is valid UTF-8 before lexing it, skipping over ASCII with SIMD.
+// so identifiers can be decoded without checking each codepoint again.
+// set this to 0 to only check the UTF-8 in identifiers as they are lexed.
+#ifndef TEK_LEXER_VALIDATE_UTF8
+#define TEK_LEXER_VALIDATE_UTF8 1
+#endif
+
 #define tek_thread_sync_primitive_spin_iterations 128
 
+//
+// dump the tokens and syntax trees of every file to the paths below after each compile.
+// the benchmarks build with these set to 0.
+#ifndef TEK_DEBUG_TOKENS
 #define TEK_DEBUG_TOKENS 1
+#endif
+#ifndef TEK_DEBUG_SYNTAX_TREE
 #define TEK_DEBUG_SYNTAX_TREE 1
+#endif
 #define tek_debug_tokens_path "/tmp/tek_tokens"
 #define tek_lexer_cap_open_brackets 128
 #define tek_debug_syntax_tree_path "/tmp/tek_syntax_tree"
 
+//
+// source files up to this size are read straight into the file's code_buf segment.
+// larger files are memory mapped instead, see TekCompiler_file_get_or_create,
+// and are only copied into the code_buf if TekLexer_relex edits them.
+#define tek_file_code_read_max_size 0x10000 // 64KB
+
+//
+// when a compiler memory segment is reset, this many bytes at the start are zeroed and kept committed
+// instead of being given back to the OS. so small compiles do not keep faulting the same pages in.
+#define tek_mem_segs_warm_size 0x10000 // 64KB
+
+//
+// the most segment groups of each kind that are kept around to be reused in the next compile.
+#define tek_seg_group_pool_cap 65536
+
+//
+// the number of syntax tree nodes reserved for each token.
+// this is used to size the syntax tree segments of a file from the size of its code.
+// this is not a bound that the grammar guarantees, a file that needs more nodes gets
+// the TekErrorKind_gen_syn_file_has_too_many_nodes error.
+#define tek_syn_nodes_per_token_max 8
+
+//
+// memory mapped source files up to this size are pre-faulted when they are mapped.
+// larger files are mapped with sequential read-ahead so the lexer can start on the
+// beginning of the file while the rest is still being read in.
+#define tek_file_code_populate_max_size 0x1000000 // 16MB
+
 //===========================================================================================
 //
 //
@@ -1,12 +1,40 @@
 #include "internal.h"
 
+#define TekGenSyn_error_token(w, error_kind) \
+	{ \
+		TekError* _e = TekCompiler_error_add(w->c, error_kind); \
+		_e->args[0].file_id = w->gen_syn.file_id; \
+		_e->args[0].token_idx = w->gen_syn.token_idx; \
+	}
+
+#define TekGenSyn_ensure_token_rewind(w, token, expected_token, error_kind, num) \
+	if (token != expected_token) { \
+		w->gen_syn.token_idx -= num; \
+		TekGenSyn_error_token(w, error_kind); \
+		return NULL; \
+	}
+
+#define TekGenSyn_ensure_token(w, token, expected_token, error_kind) TekGenSyn_ensure_token_rewind(w, token, expected_token, error_kind, 0)
+
+//
+// the syntax tree segment of a file is sized from its code, see tek_syn_nodes_per_token_max.
+// nothing guards the end of that segment, so running out of nodes is an error for the file.
+// @return: NULL if there is no room left for the node.
 TekSynNode* TekGenSyn_alloc_node_list_header(TekWorker* w) {
+	if (w->gen_syn.nodes_next_idx >= w->gen_syn.nodes_cap) {
+		TekGenSyn_error_token(w, TekErrorKind_gen_syn_file_has_too_many_nodes);
+		return NULL;
+	}
 	TekSynNode* node = &w->gen_syn.nodes[w->gen_syn.nodes_next_idx];
 	w->gen_syn.nodes_next_idx += 1;
 	return node;
 }
 
 TekSynNode* TekGenSyn_alloc_node(TekWorker* w, TekSynNodeKind kind, uint32_t token_idx, TekBool header_only) {
+	if (w->gen_syn.nodes_next_idx + 2 > w->gen_syn.nodes_cap) {
+		TekGenSyn_error_token(w, TekErrorKind_gen_syn_file_has_too_many_nodes);
+		return NULL;
+	}
 	TekSynNode* node = &w->gen_syn.nodes[w->gen_syn.nodes_next_idx];
 	w->gen_syn.nodes_next_idx += header_only ? 1 : 2;
 
@@ -43,22 +71,6 @@ static inline const TekValue* TekGenSyn_token_value_take(TekWorker* w) {
 	return v;
 }
 
-#define TekGenSyn_error_token(w, error_kind) \
-	{ \
-		TekError* _e = TekCompiler_error_add(w->c, error_kind); \
-		_e->args[0].file_id = w->gen_syn.file_id; \
-		_e->args[0].token_idx = w->gen_syn.token_idx; \
-	}
-
-#define TekGenSyn_ensure_token_rewind(w, token, expected_token, error_kind, num) \
-	if (token != expected_token) { \
-		w->gen_syn.token_idx -= num; \
-		TekGenSyn_error_token(w, error_kind); \
-		return NULL; \
-	}
-
-#define TekGenSyn_ensure_token(w, token, expected_token, error_kind) TekGenSyn_ensure_token_rewind(w, token, expected_token, error_kind, 0)
-
 //
 // new lines are combined in the lexer, so we only have to check once.
 #define TekGenSyn_skip_new_lines(w, token) \
@@ -121,12 +133,15 @@ TekBool TekGenSyn_gen_file(TekWorker* w, TekFileId file_id) {
 	TekFile* file = TekCompiler_file_get(w->c, file_id);
 	w->gen_syn.nodes = TekFile_syntax_tree_nodes(file);
 	w->gen_syn.nodes_next_idx = 0;
+	w->gen_syn.nodes_cap = file->segment_sizes[TekMemSegFile_syntax_tree_nodes] / sizeof(TekSynNode);
 	w->gen_syn.tokens = TekFile_tokens(file);
 	w->gen_syn.token_values = TekFile_token_values(file);
 	w->gen_syn.token_idx = 0;
+	w->gen_syn.token_value_idx = 0;
 	w->gen_syn.file_id = file_id;
 
 	TekSynNode* mod = TekGenSyn_gen_mod(w, 0, tek_true);
+	file->syntax_tree_nodes_count = w->gen_syn.nodes_next_idx;
 	/*
 	//
 	// if no errors occurred, then queue a job to generate a semantic tree for the whole file.
@@ -140,6 +155,7 @@ TekBool TekGenSyn_gen_file(TekWorker* w, TekFileId file_id) {
 
 TekSynNode* TekGenSyn_gen_mod(TekWorker* w, uint32_t token_idx, TekBool is_file_root) {
 	TekSynNode* node = TekGenSyn_alloc_node(w, TekSynNodeKind_mod, token_idx, tek_false);
+	tek_ensure(node);
 	TekToken token = TekGenSyn_token_peek(w);
 
 	if (!is_file_root) {
@@ -177,8 +193,9 @@ TekSynNode* TekGenSyn_gen_mod(TekWorker* w, uint32_t token_idx, TekBool is_file_
 
 				//
 				// allocate a declaration and link the left hand side.
-				TekGenSyn_alloc_node_list_header(w);
+				tek_ensure(TekGenSyn_alloc_node_list_header(w));
 				entry = TekGenSyn_alloc_node(w, TekSynNodeKind_decl, w->gen_syn.token_idx, tek_false);
+				tek_ensure(entry);
 				entry[1].decl.ident_rel_idx = tek_rel_idx_s16(TekSynNode, ident, entry);
 
 				//
@@ -248,6 +265,7 @@ TekSynNode* TekGenSyn_gen_var(TekWorker* w, uint32_t token_idx, TekBool is_globa
 
 TekSynNode* TekGenSyn_gen_var_stub(TekWorker* w, uint32_t token_idx, TekBool is_global) {
 	TekSynNode* node = TekGenSyn_alloc_node(w, TekSynNodeKind_var, token_idx, tek_false);
+	tek_ensure(node);
 
 	//
 	// generate the types if this is not the end of the var and we do not have an assign symbol.
@@ -279,12 +297,14 @@ EXIT_FLAGS: {}
 TekSynNode* TekGenSyn_gen_import(TekWorker* w) {
 	TekToken token = TekGenSyn_token_peek(w);
 
-	TekGenSyn_alloc_node_list_header(w);
+	tek_ensure(TekGenSyn_alloc_node_list_header(w));
 	TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_import, w->gen_syn.token_idx, tek_false);
+	tek_ensure(stmt);
 	TekSynNode* node = NULL;
 	token = TekGenSyn_token_move_next(w);
 	if (token == TekToken_lit_string) {
 		node = TekGenSyn_alloc_node(w, TekSynNodeKind_import_file, w->gen_syn.token_idx, tek_false);
+		tek_ensure(node);
 
 		//
 		// get the file path from the string table
@@ -363,6 +383,7 @@ TekSynNode* TekGenSyn_gen_type_struct(TekWorker* w, uint32_t token_idx, TekBool
 					//
 					// lets process the left hand side (identifier) first
 					TekSynNode* ident = TekGenSyn_alloc_node(w, TekSynNodeKind_ident, w->gen_syn.token_idx, tek_false);
+					tek_ensure(ident);
 					ident[1].ident_str_id = TekGenSyn_token_value_take(w)->str_id;
 
 					//
@@ -372,8 +393,9 @@ TekSynNode* TekGenSyn_gen_type_struct(TekWorker* w, uint32_t token_idx, TekBool
 
 					//
 					// allocate a field and link the left hand side.
-					TekGenSyn_alloc_node_list_header(w);
+					tek_ensure(TekGenSyn_alloc_node_list_header(w));
 					field = TekGenSyn_alloc_node(w, TekSynNodeKind_struct_field, w->gen_syn.token_idx, tek_false);
+					tek_ensure(field);
 					field[1].struct_field.ident_rel_idx = tek_rel_idx_s(TekSynNode, TekSynNode_bits_struct_field_ident_rel_idx, ident, field);
 
 					//
@@ -415,6 +437,7 @@ TekSynNode* TekGenSyn_gen_type_struct(TekWorker* w, uint32_t token_idx, TekBool
 
 TekSynNode* TekGenSyn_gen_type_struct_stub(TekWorker* w, uint32_t token_idx) {
 	TekSynNode* node = TekGenSyn_alloc_node(w, TekSynNodeKind_type_struct, token_idx, tek_false);
+	tek_ensure(node);
 
 	TekToken token = TekGenSyn_token_peek(w);
 	TekAbi abi = TekAbi_tek;
@@ -459,6 +482,7 @@ TekSynNode* TekGenSyn_gen_proc_stub(TekWorker* w, uint32_t token_idx, TekBool is
 	TekToken token = TekGenSyn_token_peek(w);
 
 	TekSynNode* node = TekGenSyn_alloc_node(w, is_type ? TekSynNodeKind_type_proc : TekSynNodeKind_proc, token_idx, tek_false);
+	tek_ensure(node);
 
 	TekGenSyn_skip_new_lines(w, token);
 	TekGenSyn_ensure_token_rewind(w, token, '(', TekErrorKind_gen_syn_proc_expected_parentheses, 1);
@@ -514,8 +538,9 @@ PROCESS_START:
 	while (token != ')') {
 		TekGenSyn_skip_new_lines(w, token);
 
-		TekGenSyn_alloc_node_list_header(w);
+		tek_ensure(TekGenSyn_alloc_node_list_header(w));
 		TekSynNode* param = TekGenSyn_alloc_node(w, is_return_params ? TekSynNodeKind_proc_param_return : TekSynNodeKind_proc_param, w->gen_syn.token_idx, tek_false);
+		tek_ensure(param);
 
 		//
 		// check to see if the parameter allows for variable arguments
@@ -533,6 +558,7 @@ PROCESS_START:
 		//
 		// lets process the left hand side (identifier) first
 		TekSynNode* ident = TekGenSyn_alloc_node(w, TekSynNodeKind_ident, w->gen_syn.token_idx, tek_false);
+		tek_ensure(ident);
 		ident[1].ident_str_id = TekGenSyn_token_value_take(w)->str_id;
 		param[1].proc_param.ident_rel_idx = tek_rel_idx_u(TekSynNode, TekSynNode_bits_proc_param_ident_rel_idx, ident, param);
 
@@ -640,6 +666,7 @@ TekSynNode* TekGenSyn_gen_type_multi(TekWorker* w) {
 		//
 		// add this type to the linked list chain
 		TekSynNode* header = TekGenSyn_alloc_node_list_header(w);
+		tek_ensure(header);
 		header->list_header.kind = TekSynNodeKind_expr_list_header;
 		header->list_header.item_rel_idx = tek_rel_idx_s(TekSynNode, TekSynNode_bits_list_header_item_rel_idx, expr, header);
 		if (prev_header)
@@ -658,6 +685,7 @@ TekSynNode* TekGenSyn_gen_type_multi(TekWorker* w) {
 	//
 	// create a wrapper node to hold the multiple expression and a count.
 	TekSynNode* multi_expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_multi, token_idx, tek_false);
+	tek_ensure(multi_expr);
 	multi_expr[1].expr_multi.count = count;
 	multi_expr[1].expr_multi.list_head_rel_idx = tek_rel_idx_s16(TekSynNode, first_header, multi_expr);
 
@@ -673,6 +701,7 @@ TekSynNode* TekGenSyn_gen_type(TekWorker* w, TekBool is_required) {
 		case TekToken_directive_volatile: {
 			uint32_t token_idx = w->gen_syn.token_idx;
 			type_qual = TekGenSyn_alloc_node(w, TekSynNodeKind_type_qualifier, token_idx, tek_false);
+			tek_ensure(type_qual);
 
 			while (1) {
 				uint32_t rel_token_idx = w->gen_syn.token_idx - token_idx;
@@ -709,6 +738,7 @@ TYPE_QUAL_END: {}
 	switch (token) {
 		case TekToken_double_full_stop: {
 			type = TekGenSyn_alloc_node(w, TekSynNodeKind_type_range, w->gen_syn.token_idx, tek_false);
+			tek_ensure(type);
 			token = TekGenSyn_token_move_next(w);
 
 			TekSynNode* expr = TekGenSyn_gen_expr(w);
@@ -752,6 +782,7 @@ PTR:
 				return NULL;
 			} else {
 				type = TekGenSyn_alloc_node(w, TekSynNodeKind_type_implicit, w->gen_syn.token_idx, tek_false);
+				tek_ensure(type);
 			}
 			break;
 	}
@@ -766,6 +797,7 @@ PTR:
 
 TekSynNode* TekGenSyn_gen_type_ptr(TekWorker* w, TekSynNodeKind kind) {
 	TekSynNode* type = TekGenSyn_alloc_node(w, kind, w->gen_syn.token_idx, tek_false);
+	tek_ensure(type);
 
 	TekToken token = TekGenSyn_token_move_next(w);
 
@@ -805,6 +837,7 @@ TekSynNode* TekGenSyn_gen_type_array(TekWorker* w) {
 	}
 
 	TekSynNode* type = TekGenSyn_alloc_node(w, kind, w->gen_syn.token_idx, tek_false);
+	tek_ensure(type);
 
 	TekSynNode* count_expr = TekGenSyn_gen_expr(w);
 	tek_ensure(count_expr);
@@ -825,6 +858,7 @@ TekSynNode* TekGenSyn_gen_type_array(TekWorker* w) {
 
 TekSynNode* TekGenSyn_gen_type_bounded_int(TekWorker* w, TekBool is_signed) {
 	TekSynNode* type = TekGenSyn_alloc_node(w, TekSynNodeKind_type_bounded_int, w->gen_syn.token_idx, tek_false);
+	tek_ensure(type);
 	type[1].type_bounded_int.is_signed = is_signed;
 
 	TekToken token = TekGenSyn_token_move_next(w);
@@ -865,6 +899,7 @@ TekSynNode* TekGenSyn_gen_expr_multi(TekWorker* w, TekBool process_named_args, T
 			// we found a colon after the expression, so wrap this in a named argument expression.
 			// put the previously generated expression as the identifier of this named argument.
 			TekSynNode* named_arg_expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_named_arg, w->gen_syn.token_idx, tek_false);
+			tek_ensure(named_arg_expr);
 			named_arg_expr[1].expr_named_arg.ident_rel_idx = tek_rel_idx_s16(TekSynNode, expr, named_arg_expr);
 
 			//
@@ -902,6 +937,7 @@ TekSynNode* TekGenSyn_gen_expr_multi(TekWorker* w, TekBool process_named_args, T
 		//
 		// add this expression to the linked list chain
 		TekSynNode* header = TekGenSyn_alloc_node_list_header(w);
+		tek_ensure(header);
 		header->list_header.kind = TekSynNodeKind_expr_list_header;
 		header->list_header.item_rel_idx = tek_rel_idx_s(TekSynNode, TekSynNode_bits_list_header_item_rel_idx, expr, header);
 		if (prev_header)
@@ -920,6 +956,7 @@ TekSynNode* TekGenSyn_gen_expr_multi(TekWorker* w, TekBool process_named_args, T
 	//
 	// create a wrapper node to hold the multiple expression and a count.
 	TekSynNode* multi_expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_multi, token_idx, tek_false);
+	tek_ensure(multi_expr);
 	multi_expr[1].expr_multi.count = count;
 	multi_expr[1].expr_multi.list_head_rel_idx = tek_rel_idx_s16(TekSynNode, first_header, multi_expr);
 
@@ -983,6 +1020,7 @@ TekSynNode* TekGenSyn_gen_expr_with(TekWorker* w, uint8_t min_precedence) {
 		}
 
 		TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_op_binary, binary_op_token_idx, tek_false);
+		tek_ensure(expr);
 		expr[1].binary.op = binary_op;
 		expr[1].binary.left_rel_idx = tek_rel_idx_s(TekSynNode, TekSynNode_bits_binary_left_rel_idx, left_expr, expr);
 
@@ -1012,6 +1050,7 @@ TekSynNode* TekGenSyn_gen_expr_unary(TekWorker* w, TekBool is_field_access) {
 IDENT:
 		{
 			TekSynNode* expr = TekGenSyn_alloc_node(w, kind, w->gen_syn.token_idx, tek_false);
+			tek_ensure(expr);
 			expr[1].ident_str_id = TekGenSyn_token_value_take(w)->str_id;
 			TekGenSyn_token_move_next(w);
 			return expr;
@@ -1024,6 +1063,7 @@ IDENT:
 VALUE:
 		{
 			TekSynNode* expr = TekGenSyn_alloc_node(w, kind, w->gen_syn.token_idx, tek_false);
+			tek_ensure(expr);
 			expr[1].token_value_idx = w->gen_syn.token_value_idx;
 			w->gen_syn.token_value_idx += 1;
 			TekGenSyn_token_move_next(w);
@@ -1038,6 +1078,7 @@ VALUE:
 			}
 
 			TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_up_parent_mods, token_idx, tek_false);
+			tek_ensure(expr);
 			expr[1].expr_up_parent_mods.count = up_parent_mods_count;
 
 			TekSynNode* sub_expr = TekGenSyn_gen_expr_unary(w, tek_false);
@@ -1049,6 +1090,7 @@ VALUE:
 
 		case '.': {
 			TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_root_mod, w->gen_syn.token_idx, tek_false);
+			tek_ensure(expr);
 			token = TekGenSyn_token_move_next(w);
 
 			TekSynNode* sub_expr = TekGenSyn_gen_expr_unary(w, tek_false);
@@ -1069,6 +1111,7 @@ UNARY:
 		{
 			if (is_field_access) {
 				TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_op_unary, w->gen_syn.token_idx, tek_false);
+				tek_ensure(expr);
 				expr[1].unary.op = unary_op;
 				TekGenSyn_token_move_next(w);
 				return expr;
@@ -1113,6 +1156,7 @@ STMT_BLOCK:
 
 		case '[': {
 			TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_lit_array, w->gen_syn.token_idx, tek_false);
+			tek_ensure(expr);
 			TekGenSyn_token_move_next(w);
 
 			TekSynNode* values_expr = TekGenSyn_gen_expr_multi(w, tek_true, tek_true);
@@ -1142,6 +1186,7 @@ TYPE_REF:
 
 		case TekToken_ellipsis: {
 			TekSynNode* node = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_vararg_spread, w->gen_syn.token_idx, tek_false);
+			tek_ensure(node);
 			token = TekGenSyn_token_move_next(w);
 
 			TekSynNode* expr = TekGenSyn_gen_expr_unary(w, tek_false);
@@ -1159,7 +1204,8 @@ TekSynNode* TekGenSyn_gen_expr_if(TekWorker* w) {
 	TekGenSyn_assert_tokens(w, token, TekToken_if, TekToken_compile_time_if);
 
 	TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_if, w->gen_syn.token_idx, tek_false);
-	TekGenSyn_alloc_node_list_header(w); // allocate the node to hold the index to the else block.
+	tek_ensure(expr);
+	tek_ensure(TekGenSyn_alloc_node_list_header(w)); // allocate the node to hold the index to the else block.
 	TekGenSyn_token_move_next(w);
 
 	//
@@ -1212,6 +1258,7 @@ TekSynNode* TekGenSyn_gen_expr_match(TekWorker* w) {
 	TekGenSyn_assert_tokens(w, token, TekToken_match, TekToken_compile_time_match);
 
 	TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_match, w->gen_syn.token_idx, tek_false);
+	tek_ensure(expr);
 	token = TekGenSyn_token_move_next(w);
 
 	TekSynNode* cond_expr = TekGenSyn_gen_expr_multi(w, tek_false, tek_false);
@@ -1232,7 +1279,7 @@ TekSynNode* TekGenSyn_gen_expr_match(TekWorker* w) {
 		// directly follow this in memory.
 		// so the next TekGenSyn_alloc_node to happen must be the one that
 		// gets put in the variable 'case_expr'.
-		TekGenSyn_alloc_node_list_header(w);
+		tek_ensure(TekGenSyn_alloc_node_list_header(w));
 
 		//
 		// we either have a case, else or an statement block for cases.
@@ -1240,6 +1287,7 @@ TekSynNode* TekGenSyn_gen_expr_match(TekWorker* w) {
 		switch (token) {
 			case TekToken_case:
 				case_expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_match_case, w->gen_syn.token_idx, tek_false);
+				tek_ensure(case_expr);
 				TekGenSyn_token_move_next(w);
 
 				TekSynNode* sub_expr = TekGenSyn_gen_expr_multi(w, tek_false, tek_false);
@@ -1250,6 +1298,7 @@ TekSynNode* TekGenSyn_gen_expr_match(TekWorker* w) {
 
 			case TekToken_else:
 				case_expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_match_else, w->gen_syn.token_idx, tek_false);
+				tek_ensure(case_expr);
 				TekGenSyn_token_move_next(w);
 				break;
 
@@ -1260,6 +1309,7 @@ TekSynNode* TekGenSyn_gen_expr_match(TekWorker* w) {
 				TekGenSyn_error_token(w, TekErrorKind_gen_syn_expr_match_unexpected_token);
 				return NULL;
 		}
+		tek_ensure(case_expr);
 
 		//
 		// add the case to the linked list chain
@@ -1288,7 +1338,8 @@ END:
 
 TekSynNode* TekGenSyn_gen_expr_for(TekWorker* w) {
 	TekSynNode* expr = TekGenSyn_alloc_node(w, TekSynNodeKind_expr_for, w->gen_syn.token_idx, tek_false);
-	TekGenSyn_alloc_node_list_header(w); // allocate the node to hold the index to the statement block of the for loop.
+	tek_ensure(expr);
+	tek_ensure(TekGenSyn_alloc_node_list_header(w)); // allocate the node to hold the index to the statement block of the for loop.
 	TekToken token = TekGenSyn_token_move_next(w);
 
 	TekSynNode* identifiers_list_head_expr = TekGenSyn_gen_expr_multi(w, tek_false, tek_false);
@@ -1358,6 +1409,7 @@ TekSynNode* TekGenSyn_gen_stmt_block(TekWorker* w) {
 
 TekSynNode* TekGenSyn_gen_stmt_block_with(TekWorker* w, TekSynNodeKind kind) {
 	TekSynNode* expr = TekGenSyn_alloc_node(w, kind, w->gen_syn.token_idx, tek_false);
+	tek_ensure(expr);
 
 	//
 	// move off the curly brace
@@ -1379,6 +1431,7 @@ TekSynNode* TekGenSyn_gen_stmt_block_with(TekWorker* w, TekSynNodeKind kind) {
 		//
 		// create a list header to link to the next statment.
 		TekSynNode* header = TekGenSyn_alloc_node_list_header(w);
+		tek_ensure(header);
 		header->list_header.kind = TekSynNodeKind_stmt_list_header;
 		header->list_header.item_rel_idx = tek_rel_idx_s(TekSynNode, TekSynNode_bits_list_header_item_rel_idx, stmt, header);
 
@@ -1407,6 +1460,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 	switch (token) {
 		case TekToken_return: {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_return, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 			token = TekGenSyn_token_move_next(w);
 
 			//
@@ -1414,6 +1468,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 			if (token == TekToken_label) {
 				stmt[1].stmt_return.has_label = tek_true;
 				TekSynNode* node = TekGenSyn_alloc_node_list_header(w); // allocate an extra node that directly follows the return statement to hold the label
+				tek_ensure(node);
 				node->label_str_id = TekGenSyn_token_value_take(w)->str_id;
 				token = TekGenSyn_token_move_next(w);
 			}
@@ -1431,6 +1486,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 		};
 		case TekToken_continue: {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_continue, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 			token = TekGenSyn_token_move_next(w);
 
 			//
@@ -1444,6 +1500,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 		};
 		case TekToken_defer: {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_defer, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 			token = TekGenSyn_token_move_next(w);
 
 			if (token == '\n' && TekGenSyn_token_peek_ahead(w, 1) == '{') {
@@ -1463,6 +1520,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 		};
 		case TekToken_goto: {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_goto, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 			TekGenSyn_token_move_next(w);
 
 			TekSynNode* expr = TekGenSyn_gen_expr(w);
@@ -1473,6 +1531,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 		};
 		case TekToken_directive_fallthrough: {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_fallthrough, w->gen_syn.token_idx, tek_true);
+			tek_ensure(stmt);
 			TekGenSyn_token_move_next(w);
 			return stmt;
 		};
@@ -1491,6 +1550,7 @@ TekSynNode* TekGenSyn_gen_stmt(TekWorker* w) {
 	switch (token) {
 		case ':': {
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_decl, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 
 			//
 			// the expression we just generated is used as the identifier for this declaration
@@ -1551,6 +1611,7 @@ BINARY_OP:
 			//
 			// we have a assign statement here
 			TekSynNode* stmt = TekGenSyn_alloc_node(w, TekSynNodeKind_stmt_assign, w->gen_syn.token_idx, tek_false);
+			tek_ensure(stmt);
 			stmt[1].binary.op = binary_op;
 
 			//
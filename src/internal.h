@@ -150,7 +150,7 @@ extern char* TekAbi_strings[TekProcCallConv_COUNT];
 //
 //
 //===========================================================================================
-#define TekLinearAlctor_cap 0x1000000000 // 10GB
+#define TekLinearAlctor_cap 0x1000000000 // 64GB
 
 #define Tek1TB   0x10000000000
 #define Tek512GB 0x8000000000
@@ -206,7 +206,13 @@ enum {
 	TekMemSegCompiler_strtab_strings, // char
 	TekMemSegCompiler_jobs, // TekJob
 	TekMemSegCompiler_errors, // TekError
+	TekMemSegCompiler_overlay_path_str_ids, // TekStrId
+	//
+	// the segments from here on are kept between compiles,
+	// so they are not reset by TekCompiler_compile_start.
+	TekMemSegCompiler_seg_group_pool, // TekSegGroupPool
 	TekMemSegCompiler_COUNT,
+	TekMemSegCompiler_RESET_COUNT = TekMemSegCompiler_seg_group_pool,
 };
 
 static uintptr_t TekMemSegCompiler_sizes[TekMemSegCompiler_COUNT] = {
@@ -220,7 +226,10 @@ static uintptr_t TekMemSegCompiler_sizes[TekMemSegCompiler_COUNT] = {
 	[TekMemSegCompiler_strtab_strings] = Tek8GB,
 	[TekMemSegCompiler_jobs] = Tek4MB,
 	[TekMemSegCompiler_errors] = Tek4MB,
+	[TekMemSegCompiler_overlay_path_str_ids] = Tek1MB,
+	[TekMemSegCompiler_seg_group_pool] = Tek16MB,
 };
+extern char* TekMemSegCompiler_strings[TekMemSegCompiler_COUNT];
 
 typedef uint8_t TekMemSegLib;
 enum {
@@ -235,32 +244,80 @@ static uintptr_t TekMemSegLib_sizes[TekMemSegLib_COUNT] = {
 	[TekMemSegLib_dependers] = Tek1MB,
 	[TekMemSegLib_dependencies] = Tek1MB,
 };
+extern char* TekMemSegLib_strings[TekMemSegLib_COUNT];
 
 typedef uint8_t TekMemSegFile;
 enum {
-	TekMemSegFile_token_locs, // TekTokenLoc
+	TekMemSegFile_token_locs, // TekTokenLocCompact
 	TekMemSegFile_tokens, // TekToken
 	TekMemSegFile_token_values, // TekValue
+	//
+	// for a pair of brackets, both the open and the close hold the number of tokens from the open to the close,
+	// so a whole bracketed body can be skipped over in either direction without looking at its tokens.
+	// they are stored as a distance so the pairs after an edit are still right when TekLexer_relex moves them.
+	// it is 0 for an open bracket that was never closed and for every other token.
+	// read it with TekFile_bracket_close_idx and TekFile_bracket_open_idx.
+	TekMemSegFile_bracket_matches, // uint32_t
 	TekMemSegFile_string_buf, // char
 	TekMemSegFile_line_code_start_indices, // uintptr_t
 	TekMemSegFile_syntax_tree_nodes, // TekSynNode
 	TekMemSegFile_syntax_tree_array_node_indices, // uint32_t
+	TekMemSegFile_code_buf, // char
 	TekMemSegFile_COUNT,
 };
+extern char* TekMemSegFile_strings[TekMemSegFile_COUNT];
+
+//
+// the file segments are sized from the size of the file's code rounded up to a power of two.
+// each power of two is a class, so a segment group can be reused by any file in the same class.
+// the classes go from 4KB up to 4GB.
+//
+#define TekFileSegClass_min_code_size_log2 12
+#define TekFileSegClass_COUNT 21
 
-static uintptr_t TekMemSegFile_sizes[TekMemSegFile_COUNT] = {
-	[TekMemSegFile_token_locs] = Tek4GB,
-	[TekMemSegFile_tokens] = Tek4GB,
-	[TekMemSegFile_token_values] = Tek4GB,
-	[TekMemSegFile_string_buf] = Tek4GB,
-	[TekMemSegFile_line_code_start_indices] = Tek4GB,
-	[TekMemSegFile_syntax_tree_nodes] = Tek4GB,
-	[TekMemSegFile_syntax_tree_array_node_indices] = Tek4GB,
+static inline uint8_t TekFileSegClass_from_code_size(uintptr_t code_size) {
+	if (code_size <= (1 << TekFileSegClass_min_code_size_log2)) return 0;
+	return (64 - __builtin_clzll(code_size - 1)) - TekFileSegClass_min_code_size_log2;
+}
+
+//
+// see TekFile_segment_sizes in compiler.c
+void TekFile_segment_sizes(uint8_t seg_class, uintptr_t* sizes_out);
+
+//
+// segment groups that have been decommitted and are waiting to be handed out again.
+// groups are only given back to the pool in TekCompiler_compile_start before any workers
+// are running, so the workers only ever need to take from it.
+typedef struct TekSegGroupPool TekSegGroupPool;
+struct TekSegGroupPool {
+	_Atomic uint32_t libs_count;
+	_Atomic uint32_t files_counts[TekFileSegClass_COUNT];
+	void* libs[tek_seg_group_pool_cap][TekMemSegLib_COUNT];
+	// the file segments are contiguous, so only the start of the group is stored.
+	void* files[TekFileSegClass_COUNT][tek_seg_group_pool_cap];
+};
+
+typedef uint8_t TekMemSegsFlags;
+enum {
+	// a no access page is placed after each segment to catch overflows
+	TekMemSegsFlags_guard_pages = 0x1,
+	// segments that are at least tek_huge_page_size start on a huge page boundary
+	// and the OS is asked to back them with transparent huge pages.
+	TekMemSegsFlags_huge_pages = 0x2,
 };
 
-TekVirtMemError tek_mem_segs_reserve(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments_out);
-TekVirtMemError tek_mem_segs_reset(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments);
-TekVirtMemError tek_mem_segs_release(uint8_t memsegs_count, uintptr_t* memsegs_sizes, void** segments_in_out);
+//
+// works out where each segment sits in a group that starts at @param(mem).
+// @param(mem) must be aligned to tek_huge_page_size when using TekMemSegsFlags_huge_pages.
+// @param(segments_out) can be NULL to just get the total size.
+// @return: the total size of the group.
+uintptr_t tek_mem_segs_layout(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void* mem, void** segments_out);
+TekVirtMemError tek_mem_segs_reserve(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void** segments_out);
+//
+// zeroes the first @param(memsegs_used_sizes) bytes of each segment, the rest must be untouched.
+// the first @param(warm_size) bytes are kept committed and the rest is decommitted.
+TekVirtMemError tek_mem_segs_reset(uint8_t memsegs_count, uintptr_t* memsegs_used_sizes, uintptr_t warm_size, void** segments);
+TekVirtMemError tek_mem_segs_release(uint8_t memsegs_count, uintptr_t* memsegs_sizes, TekMemSegsFlags flags, void** segments_in_out);
 
 //===========================================================================================
 //
@@ -270,6 +327,8 @@ TekVirtMemError tek_mem_segs_release(uint8_t memsegs_count, uintptr_t* memsegs_s
 //
 //===========================================================================================
 
+//
+// the full location of a token, see TekFile_token_loc.
 typedef struct TekTokenLoc TekTokenLoc;
 struct TekTokenLoc {
 	uint32_t code_idx_start;
@@ -278,6 +337,16 @@ struct TekTokenLoc {
 	uint32_t column;
 };
 
+//
+// the form that the lexer stores the token locations of a file in.
+// the line and column are only needed for error messages, so they are worked out
+// from the file's line_code_start_indices when they are needed, see TekFile_token_loc.
+typedef struct TekTokenLocCompact TekTokenLocCompact;
+struct TekTokenLocCompact {
+	uint32_t code_idx_start;
+	uint32_t code_idx_end;
+};
+
 typedef uint8_t TekToken;
 extern char* TekToken_strings_non_ascii[];
 extern void TekToken_as_string(TekToken token, char* string_out, uint32_t string_out_size);
@@ -391,6 +460,25 @@ enum {
 #define TekToken_directive_START TekToken_directive_import
 #define TekToken_directive_END TekToken_directive_intrinsic
 
+//
+// @return: whether the lexer puts a value in TekFile_token_values for the token.
+//          the values are in the same order as their tokens, so a token's value index is the number of these tokens before it.
+static inline TekBool TekToken_has_value(TekToken token) {
+	switch (token) {
+		case TekToken_ident:
+		case TekToken_ident_abstract:
+		case TekToken_label:
+		case TekToken_lit_uint:
+		case TekToken_lit_sint:
+		case TekToken_lit_float:
+		case TekToken_lit_bool:
+		case TekToken_lit_string:
+			return tek_true;
+		default:
+			return tek_false;
+	}
+}
+
 //===========================================================================================
 //
 //
@@ -430,6 +518,49 @@ struct TekLexer {
 
 extern TekBool TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFileId file_id);
 
+//
+// an edit made to the code of a file that has already been lexed, see TekLexer_relex.
+typedef struct TekLexerEdit TekLexerEdit;
+struct TekLexerEdit {
+	// where the edit starts in the code from before the edit
+	uint32_t code_idx;
+	// the number of bytes from code_idx that are removed
+	uint32_t deleted_len;
+	// the bytes that are put in place of the removed ones
+	char* inserted;
+	uint32_t inserted_len;
+};
+
+//
+// the tokens that were replaced by TekLexer_relex.
+// the tokens from token_idx to token_idx + removed_count were replaced by the ones from token_idx to token_idx + added_count.
+typedef struct TekLexerRelexSpan TekLexerRelexSpan;
+struct TekLexerRelexSpan {
+	uint32_t token_idx;
+	uint32_t removed_count;
+	uint32_t added_count;
+};
+
+typedef uint8_t TekLexerRelexResult;
+enum {
+	TekLexerRelexResult_ok,
+	// the errors have been added to the compiler.
+	// a lex error leaves the tokens ending at the failed one, the same as TekLexer_lex.
+	// a close bracket that no longer matches after the edit leaves all of the tokens, so the next edit can fix it.
+	TekLexerRelexResult_error,
+	// the edited code does not fit in the file's code_buf, nothing has been changed and the file needs to be compiled again
+	TekLexerRelexResult_no_room,
+};
+
+//
+// makes the @param(edit) to the code of a file and updates its tokens, values and line starts,
+// without lexing the tokens that come before or after the edit again.
+// the tokens after the edit are moved with a memmove and their locations are left shifted, see TekFile.relex_token_idx,
+// so the cost is the size of the edit and the distance from the last edit, not the size of the file.
+// no jobs are queued, it is up to the caller to make the syntax tree again.
+// bench/relex.c checks this against TekLexer_lex.
+extern TekLexerRelexResult TekLexer_relex(TekLexer* lexer, TekCompiler* c, TekFileId file_id, TekLexerEdit* edit, TekLexerRelexSpan* span_out);
+
 //===========================================================================================
 //
 //
@@ -705,6 +836,7 @@ struct TekGenSyn {
 	uint32_t* array_node_indices;
 	TekSynNode* nodes;
 	uint32_t nodes_next_idx;
+	uint32_t nodes_cap;
 	const TekToken* tokens;
 	const TekValue* token_values;
 	uint32_t token_idx;
@@ -1131,6 +1263,7 @@ enum {
 	TekErrorKind_lexer_unsupported_token, // location: args[0].token_idx
 	TekErrorKind_lexer_expected_a_compile_time_token, // location: args[0].token_idx
 	TekErrorKind_lexer_unclosed_block_comment, // location: args[0].token_idx
+	TekErrorKind_lexer_invalid_utf8, // location: args[0].token_idx
 	TekErrorKind_lexer_invalid_string_ascii_esc_char_code_fmt, // location: args[0].token_idx
 	TekErrorKind_lexer_invalid_string_esc_sequence, // location: args[0].token_idx
 	TekErrorKind_lexer_invalid_close_bracket, // got_location: args[0].token_idx, previously_opened_location: args[1].token_idx
@@ -1172,6 +1305,7 @@ enum {
 	TekErrorKind_gen_syn_expr_for_expected_stmt_block, // location: args[0].token_idx
 	TekErrorKind_gen_syn_expr_for_expected_in_keyword, // location: args[0].token_idx
 	TekErrorKind_gen_syn_stmt_only_allow_var_decl, // location: args[0].token_idx
+	TekErrorKind_gen_syn_file_has_too_many_nodes, // location: args[0].token_idx
 
 	TekErrorKind_COUNT,
 };
@@ -1221,11 +1355,40 @@ struct TekJobList {
 	TekSpinMtx mtx;
 };
 
+typedef uint8_t TekFileFlags;
+enum {
+	// the code is owned by the caller, see TekFileOverlay
+	TekFileFlags_is_overlay = 0x1,
+	// the code is memory mapped and TekFile.handle is open
+	TekFileFlags_is_mapped = 0x2,
+	// TekLexer_relex found a close bracket that no longer matches, so the bracket_matches cannot be trusted
+	// and the next relex lexes the whole file again.
+	TekFileFlags_is_bracket_mismatched = 0x4,
+};
+
+//
+// how much of a file's memory is still needed by the compile, see _TekCompiler_out_of_mem_handler.
+typedef uint8_t TekFileMemState;
+enum {
+	// jobs are still to be run on the file
+	TekFileMemState_in_use,
+	// every job has finished with the file, only what is kept until the next compile is needed
+	TekFileMemState_finished,
+	// finished and the out of memory handler has given back the rest
+	TekFileMemState_trimmed,
+};
+
 struct TekFile {
 	void* segments[TekMemSegFile_COUNT];
+	uintptr_t segment_sizes[TekMemSegFile_COUNT];
+	uint8_t seg_class;
 	char* code;
 	uintptr_t size;
 	TekVirtMemFileHandle handle;
+	TekFileFlags flags;
+	_Atomic TekFileMemState mem_state;
+	// what the file is counted as in TekCompiler.files_in_flight_size when there is a TekCompileArgs.mem_limit.
+	uintptr_t in_flight_size;
 	TekFileId id;
 	TekStrId path_str_id;
 	//
@@ -1235,15 +1398,92 @@ struct TekFile {
 	uint32_t token_values_count;
 	uint32_t lines_count;
 	uint32_t syntax_tree_nodes_count;
+	//
+	// TekLexer_relex leaves the code indices of the tokens and lines after an edit where they were,
+	// so an edit does not have to rewrite every one of them. the token locations from relex_token_idx on
+	// and the line starts from relex_line_idx on are relex_code_idx_shift short of where they really are,
+	// see TekFile_token_loc_compact and TekFile_line_code_start_idx.
+	// relex_values_count is the number of token values before relex_token_idx, so the next relex
+	// only counts the values between the two edits. TekLexer_lex zeroes all of these.
+	uint32_t relex_token_idx;
+	uint32_t relex_line_idx;
+	uint32_t relex_values_count;
+	uint32_t relex_code_idx_shift;
 };
 
-static inline TekTokenLoc* TekFile_token_locs(TekFile* file) { return file->segments[TekMemSegFile_token_locs]; }
 static inline TekToken* TekFile_tokens(TekFile* file) { return file->segments[TekMemSegFile_tokens]; }
 static inline TekValue* TekFile_token_values(TekFile* file) { return file->segments[TekMemSegFile_token_values]; }
+static inline uint32_t* TekFile_bracket_matches(TekFile* file) { return file->segments[TekMemSegFile_bracket_matches]; }
 static inline char* TekFile_string_buf(TekFile* file) { return file->segments[TekMemSegFile_string_buf]; }
-static inline uintptr_t* TekFile_line_code_start_indices(TekFile* file) { return file->segments[TekMemSegFile_line_code_start_indices]; }
 static inline TekSynNode* TekFile_syntax_tree_nodes(TekFile* file) { return file->segments[TekMemSegFile_syntax_tree_nodes]; }
 static inline uint32_t* TekFile_syntax_tree_array_node_indices(TekFile* file) { return file->segments[TekMemSegFile_syntax_tree_array_node_indices]; }
+static inline char* TekFile_code_buf(TekFile* file) { return file->segments[TekMemSegFile_code_buf]; }
+
+//
+// the token locations and line starts as they are stored, without the shift that TekLexer_relex leaves
+// on the ones from TekFile.relex_token_idx and TekFile.relex_line_idx onward.
+// only the lexer and the relex check in bench/relex.c, which saves and restores them as they are, use these.
+// everything else reads them with TekFile_token_loc_compact and TekFile_line_code_start_idx.
+static inline TekTokenLocCompact* _TekFile_token_locs(TekFile* file) { return file->segments[TekMemSegFile_token_locs]; }
+static inline uintptr_t* _TekFile_line_code_start_indices(TekFile* file) { return file->segments[TekMemSegFile_line_code_start_indices]; }
+
+//
+// @return: where the token really is, with any shift that TekLexer_relex has left on it.
+static inline TekTokenLocCompact TekFile_token_loc_compact(TekFile* file, uint32_t token_idx) {
+	TekTokenLocCompact loc = _TekFile_token_locs(file)[token_idx];
+	if (token_idx >= file->relex_token_idx) {
+		loc.code_idx_start += file->relex_code_idx_shift;
+		loc.code_idx_end += file->relex_code_idx_shift;
+	}
+	return loc;
+}
+
+//
+// @return: where line @param(line_idx) + 1 really starts, with any shift that TekLexer_relex has left on it.
+static inline uintptr_t TekFile_line_code_start_idx(TekFile* file, uint32_t line_idx) {
+	uintptr_t code_idx = _TekFile_line_code_start_indices(file)[line_idx];
+	if (line_idx >= file->relex_line_idx) {
+		code_idx += (intptr_t)(int32_t)file->relex_code_idx_shift;
+	}
+	return code_idx;
+}
+
+//
+// @return: the token index of the bracket that closes the open bracket at @param(open_token_idx), or 0 if it was never closed.
+// this is only right for a file that lexed without errors, see TekMemSegFile_bracket_matches.
+static inline uint32_t TekFile_bracket_close_idx(TekFile* file, uint32_t open_token_idx) {
+	uint32_t distance = TekFile_bracket_matches(file)[open_token_idx];
+	return distance ? open_token_idx + distance : 0;
+}
+
+//
+// @return: the token index of the open bracket that the close bracket at @param(close_token_idx) closes.
+// a close bracket always has an open one in a file that lexed without errors.
+static inline uint32_t TekFile_bracket_open_idx(TekFile* file, uint32_t close_token_idx) {
+	return close_token_idx - TekFile_bracket_matches(file)[close_token_idx];
+}
+
+//
+// the last job type that reads each of the file segments.
+// once a job of this type has finished with a file, the segment is decommitted.
+// TekJobType_COUNT means the segment is kept until the next compile.
+static TekJobType TekMemSegFile_last_job_types[TekMemSegFile_COUNT] = {
+	// kept so we can still report errors.
+	[TekMemSegFile_token_locs] = TekJobType_COUNT,
+	[TekMemSegFile_tokens] = TekJobType_COUNT,
+	[TekMemSegFile_token_values] = TekJobType_COUNT,
+	// kept so the syntax tree can be made again after TekLexer_relex.
+	[TekMemSegFile_bracket_matches] = TekJobType_COUNT,
+	[TekMemSegFile_string_buf] = TekJobType_lex_file,
+	[TekMemSegFile_line_code_start_indices] = TekJobType_COUNT,
+	[TekMemSegFile_syntax_tree_nodes] = TekJobType_COUNT,
+	[TekMemSegFile_syntax_tree_array_node_indices] = TekJobType_COUNT,
+	[TekMemSegFile_code_buf] = TekJobType_COUNT,
+};
+
+//
+// works out the full location of a token, see TekTokenLocCompact
+TekTokenLoc TekFile_token_loc(TekFile* file, uint32_t token_idx);
 
 struct TekLib {
 	void* segments[TekMemSegLib_COUNT];
@@ -1281,6 +1521,7 @@ struct TekCompiler {
 	_Atomic uint16_t stalled_workers_count;
 	_Atomic uint16_t running_workers_count;
 	TekCompileArgs* compile_args;
+	uint32_t overlays_count;
 
 	void* segments[TekMemSegCompiler_COUNT];
 	_Atomic uint32_t libs_count;
@@ -1289,6 +1530,7 @@ struct TekCompiler {
 	_Atomic uint32_t errors_count;
 	_Atomic uint32_t strtab_entries_count;
 	_Atomic uintptr_t strtab_strings_size;
+	_Atomic uintptr_t files_in_flight_size;
 
 	TekMtx wait_mtx;
 
@@ -1299,6 +1541,7 @@ struct TekCompiler {
 		TekJobList free_list;
 		TekJobList type_to_job_list_map[TekJobType_COUNT];
 		TekJobList type_to_job_list_map_failed[TekJobType_COUNT];
+		TekJobList deferred_lex_list; // lex jobs waiting for memory when there is a TekCompileArgs.mem_limit
 	} job_sys;
 };
 
@@ -1311,9 +1554,31 @@ static inline _Atomic TekStrEntry* TekCompiler_strtab_entries(TekCompiler* c) {
 static inline char* TekCompiler_strtab_strings(TekCompiler* c) { return c->segments[TekMemSegCompiler_strtab_strings]; }
 static inline TekJob* TekCompiler_jobs(TekCompiler* c) { return c->segments[TekMemSegCompiler_jobs]; }
 static inline TekError* TekCompiler_errors(TekCompiler* c) { return c->segments[TekMemSegCompiler_errors]; }
+static inline _Atomic TekStrId* TekCompiler_overlay_path_str_ids(TekCompiler* c) { return c->segments[TekMemSegCompiler_overlay_path_str_ids]; }
+static inline TekSegGroupPool* TekCompiler_seg_group_pool(TekCompiler* c) { return c->segments[TekMemSegCompiler_seg_group_pool]; }
+
+//
+// an in-memory source file that is used in place of the file on disk at the same path.
+// the path does not have to exist on disk, in that case it must match exactly
+// the path that the file is imported with, otherwise symlinks and relative paths are resolved.
+// the code is not copied, so it must stay alive and unchanged until the compile has finished.
+typedef struct TekFileOverlay TekFileOverlay;
+struct TekFileOverlay {
+	char* path;
+	char* code;
+	uintptr_t size;
+};
 
 struct TekCompileArgs {
 	char* file_path;
+	TekFileOverlay* overlays;
+	uint32_t overlays_count;
+
+	//
+	// the most bytes that the files being lexed and turned into syntax trees can commit at once.
+	// when a file would go over this, it is not lexed until another file has finished.
+	// each file is counted as the most that its segments can commit, see _TekFile_in_flight_size. 0 means there is no limit.
+	uintptr_t mem_limit;
 };
 
 typedef uint8_t TekCompilerError;
@@ -1342,4 +1607,10 @@ TekCompilerError TekCompiler_compile_start(TekCompiler* c, uint16_t workers_coun
 extern TekCompilerError TekCompiler_compile_wait(TekCompiler* c);
 extern void TekCompiler_errors_string(TekCompiler* c, TekStk(char)* string_out, TekBool use_ascii_colors);
 
+//
+// writes a table of the memory used by each segment kind to @param(string_out).
+// the lib and file segments are summed across all of the libs and files.
+// call this after TekCompiler_compile_wait and before the next TekCompiler_compile_start.
+extern void TekCompiler_mem_report(TekCompiler* c, TekStk(char)* string_out);
+
 #endif // TEK_INTERNAL_H
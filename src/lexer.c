@@ -1,79 +1,228 @@
 #include "internal.h"
 
+#if TEK_LEXER_SIMD && (defined(__SSE2__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+typedef uint8_t TekLexerIdentClass;
+enum {
+	TekLexerIdentClass_invalid, // cannot be in or next to an identifier
+	TekLexerIdentClass_delimiter, // ends an identifier
+	TekLexerIdentClass_continue, // part of an identifier
+	TekLexerIdentClass_non_ascii, // the first byte of a multi byte codepoint, only used in TekLexerIdentClass_table
+};
+
+//
+// the class of each byte, this matches the generated tables below for the ASCII codepoints.
+static TekLexerIdentClass TekLexerIdentClass_table[256] = {
+	['\t'] = TekLexerIdentClass_delimiter,
+	['\n'] = TekLexerIdentClass_delimiter,
+	['\r'] = TekLexerIdentClass_delimiter,
+	[' ' ... '/'] = TekLexerIdentClass_delimiter,
+	['0' ... '9'] = TekLexerIdentClass_continue,
+	[':' ... '@'] = TekLexerIdentClass_delimiter,
+	['A' ... 'Z'] = TekLexerIdentClass_continue,
+	['[' ... '^'] = TekLexerIdentClass_delimiter,
+	['_'] = TekLexerIdentClass_continue,
+	['`'] = TekLexerIdentClass_delimiter,
+	['a' ... 'z'] = TekLexerIdentClass_continue,
+	['{' ... '~'] = TekLexerIdentClass_delimiter,
+	[0x80 ... 0xff] = TekLexerIdentClass_non_ascii,
+};
+
+//
+// the tables for the class of every codepoint are generated by build_script.c from the utf8proc data.
+// each block holds 256 codepoints at 2 bits each, and the block indices map the top bits of a codepoint to its block.
+#include "tek_ident_tables.h"
+
+static inline TekLexerIdentClass TekLexerIdentClass_from_codept(int32_t codept) {
+	uint8_t* block = TekLexerIdentClass_blocks[TekLexerIdentClass_block_indices[codept >> 8]];
+	return (block[(codept & 0xff) >> 2] >> ((codept & 0x3) * 2)) & 0x3;
+}
+
+typedef struct TekLexerKeyword TekLexerKeyword;
+struct TekLexerKeyword {
+	uint64_t packed[2]; // the keyword padded with zeros
+	TekToken token;
+};
+
+//
+// the keyword table is a perfect hash generated by build_script.c, which is also where the keywords are listed.
+#include "tek_keyword_table.h"
+
+static inline uint64_t TekLexerKeyword_hash(uint64_t* packed) {
+	return ((packed[0] ^ (packed[1] * 0x9e3779b97f4a7c15ull)) * TekLexerKeyword_hash_mult) >> (64 - TekLexerKeyword_table_size_log2);
+}
+
+//
+// the masks that keep the first n bytes of the two 8 byte halves of a packed keyword.
+static uint64_t TekLexerKeyword_packed_masks[17][2] = {
+	{ 0x0000000000000000ull, 0 }, { 0x00000000000000ffull, 0 }, { 0x000000000000ffffull, 0 }, { 0x0000000000ffffffull, 0 },
+	{ 0x00000000ffffffffull, 0 }, { 0x000000ffffffffffull, 0 }, { 0x0000ffffffffffffull, 0 }, { 0x00ffffffffffffffull, 0 },
+	{ ~0ull, 0 }, { ~0ull, 0x00000000000000ffull }, { ~0ull, 0x000000000000ffffull }, { ~0ull, 0x0000000000ffffffull },
+	{ ~0ull, 0x00000000ffffffffull }, { ~0ull, 0x000000ffffffffffull }, { ~0ull, 0x0000ffffffffffffull }, { ~0ull, 0x00ffffffffffffffull },
+	{ ~0ull, ~0ull },
+};
+
+//
+// @return: the keyword or directive token for the identifier, or TekToken_ident if it is not one.
+static inline TekToken TekLexerKeyword_find(uint8_t* ident, uint32_t ident_len, uint8_t* code_end) {
+	if (ident_len > sizeof(((TekLexerKeyword*)0)->packed)) {
+		return TekToken_ident;
+	}
+
+	//
+	// load the identifier padded with zeros. when there are 16 bytes left in the code,
+	// load them all and mask off the bytes after the identifier, otherwise copy just the identifier.
+	uint64_t packed[2] = {0};
+	if (code_end - ident >= 16) {
+		memcpy(packed, ident, 16);
+		packed[0] &= TekLexerKeyword_packed_masks[ident_len][0];
+		packed[1] &= TekLexerKeyword_packed_masks[ident_len][1];
+	} else {
+		memcpy(packed, ident, ident_len);
+	}
+
+	//
+	// identifiers never contain a zero byte, so comparing the zero padded bytes also compares the length.
+	// the empty slots are all zeros, so they never match.
+	TekLexerKeyword* keyword = &TekLexerKeyword_table[TekLexerKeyword_hash(packed)];
+	TekBool is_match = (keyword->packed[0] == packed[0]) & (keyword->packed[1] == packed[1]);
+	return is_match ? keyword->token : TekToken_ident;
+}
+
+typedef struct TekLexerOp TekLexerOp;
+struct TekLexerOp {
+	uint32_t packed; // the bytes of the operator with the first byte in the lowest byte
+	uint32_t mask; // keeps the bytes of the operator
+	uint8_t len; // 0 ends the list of operators for a first byte
+	TekToken token;
+};
+
+#define TekLexerOp_2(a, b, token_) { .packed = (a) | ((b) << 8), .mask = 0xffff, .len = 2, .token = token_ }
+#define TekLexerOp_3(a, b, c, token_) { .packed = (a) | ((b) << 8) | ((c) << 16), .mask = 0xffffff, .len = 3, .token = token_ }
+
+//
+// the operators that are more than one byte, listed under their first byte with the longest first.
+// the lexer compares these against the next 4 bytes of the code loaded as a uint32_t,
+// instead of comparing each operator byte by byte.
+#define tek_lexer_op_first_byte_cap 3
+static TekLexerOp TekLexerOp_table[128][tek_lexer_op_first_byte_cap] = {
+	['.'] = {
+		TekLexerOp_3('.', '.', '.', TekToken_ellipsis),
+		TekLexerOp_3('.', '.', '=', TekToken_double_full_stop_equal),
+		TekLexerOp_2('.', '.', TekToken_double_full_stop),
+	},
+	['+'] = {
+		TekLexerOp_3('+', '+', '=', TekToken_assign_concat),
+		TekLexerOp_2('+', '=', TekToken_assign_add),
+		TekLexerOp_2('+', '+', TekToken_concat),
+	},
+	['-'] = {
+		TekLexerOp_2('-', '=', TekToken_assign_subtract),
+		TekLexerOp_2('-', '>', TekToken_right_arrow),
+	},
+	['*'] = { TekLexerOp_2('*', '=', TekToken_assign_multiply) },
+	['/'] = { TekLexerOp_2('/', '=', TekToken_assign_divide) },
+	['%'] = { TekLexerOp_2('%', '=', TekToken_assign_remainder) },
+	['!'] = { TekLexerOp_2('!', '=', TekToken_not_equal) },
+	['&'] = {
+		TekLexerOp_2('&', '&', TekToken_double_ampersand),
+		TekLexerOp_2('&', '=', TekToken_assign_bit_and),
+	},
+	['|'] = {
+		TekLexerOp_2('|', '|', TekToken_double_pipe),
+		TekLexerOp_2('|', '=', TekToken_assign_bit_or),
+	},
+	['^'] = { TekLexerOp_2('^', '=', TekToken_assign_bit_xor) },
+	['<'] = {
+		TekLexerOp_3('<', '<', '=', TekToken_assign_bit_shift_left),
+		TekLexerOp_2('<', '=', TekToken_greater_than_or_eq),
+		TekLexerOp_2('<', '<', TekToken_double_greater_than),
+	},
+	['>'] = {
+		TekLexerOp_3('>', '>', '=', TekToken_assign_bit_shift_right),
+		TekLexerOp_2('>', '=', TekToken_less_than_or_eq),
+		TekLexerOp_2('>', '>', TekToken_double_less_than),
+	},
+	['='] = {
+		TekLexerOp_2('=', '=', TekToken_double_equal),
+		TekLexerOp_2('=', '>', TekToken_thick_right_arrow),
+	},
+	['?'] = { TekLexerOp_2('?', '!', TekToken_question_and_exclamation_mark) },
+};
+
+//
+// @return: the longest operator that starts at @param(pos), or NULL if it is a single byte operator.
+//          the first byte must be one of the ASCII symbols in TekLexerOp_table.
+static inline TekLexerOp* TekLexerOp_find(uint8_t* pos, uint8_t* code_end) {
+	//
+	// load the next 4 bytes padded with zeros at the end of the code.
+	// no operator has a zero byte, so the padding never matches.
+	uint32_t remaining_count = code_end - pos;
+	uint32_t word;
+	if (remaining_count >= 4) {
+		word = pos[0] | (pos[1] << 8) | (pos[2] << 16) | ((uint32_t)pos[3] << 24);
+	} else {
+		word = pos[0];
+		if (remaining_count > 1) word |= pos[1] << 8;
+		if (remaining_count > 2) word |= pos[2] << 16;
+	}
+
+	TekLexerOp* ops = TekLexerOp_table[pos[0]];
+	for (uint32_t i = 0; i < tek_lexer_op_first_byte_cap && ops[i].len; i += 1) {
+		if ((word & ops[i].mask) == ops[i].packed) {
+			return &ops[i];
+		}
+	}
+	return NULL;
+}
+
 static uint32_t TekLexer_identifier_byte_count(TekLexer* lexer) {
 	uint32_t token_byte_count = 0;
 	uint8_t* pos = (uint8_t*)lexer->code + lexer->code_idx;
 	uint32_t remaining_count = lexer->code_len - lexer->code_idx;
 	while (1) {
+		//
+		// nearly all identifiers are ASCII, so go through those bytes with the table
+		// and only decode the codepoints that are not.
+		if (token_byte_count >= remaining_count) {
+			break;
+		}
+
+		switch (TekLexerIdentClass_table[pos[token_byte_count]]) {
+			case TekLexerIdentClass_invalid:
+				return 0;
+			case TekLexerIdentClass_delimiter:
+				return token_byte_count;
+			case TekLexerIdentClass_continue:
+				token_byte_count += 1;
+				continue;
+			case TekLexerIdentClass_non_ascii:
+				break;
+		}
+
 		int32_t codept;
+#if TEK_LEXER_VALIDATE_UTF8
+		// the whole file has already been validated, so just decode it.
+		uint32_t codept_byte_count = tek_utf8_codepoint_to_utf32((char*)pos + token_byte_count, &codept);
+#else
 		intptr_t codept_byte_count = utf8proc_iterate(pos + token_byte_count, remaining_count - token_byte_count, &codept);
 		if (codept_byte_count < 0) {
 			return 0;
 		}
+#endif
 
-		TekBool found_delimiter = tek_false;
-		utf8proc_category_t utf8_category = utf8proc_category(codept);
-		switch (utf8_category) {
-			case UTF8PROC_CATEGORY_LU: /**< Letter, uppercase */
-			case UTF8PROC_CATEGORY_LL: /**< Letter, lowercase */
-			case UTF8PROC_CATEGORY_LT: /**< Letter, titlecase */
-			case UTF8PROC_CATEGORY_LM: /**< Letter, modifier */
-			case UTF8PROC_CATEGORY_LO: /**< Letter, other */
-			case UTF8PROC_CATEGORY_ND: /**< Number, decimal digit */
-			case UTF8PROC_CATEGORY_NL: /**< Number, letter */
-			case UTF8PROC_CATEGORY_NO: /**< Number, other */
-				break;
-			case UTF8PROC_CATEGORY_PC: /**< Punctuation, connector */
-				if (codept == U'_') {
-					break;
-				}
-				// fallthrough
-			case UTF8PROC_CATEGORY_PD: /**< Punctuation, dash */
-			case UTF8PROC_CATEGORY_PS: /**< Punctuation, open */
-			case UTF8PROC_CATEGORY_PE: /**< Punctuation, close */
-			case UTF8PROC_CATEGORY_PI: /**< Punctuation, initial quote */
-			case UTF8PROC_CATEGORY_PF: /**< Punctuation, final quote */
-			case UTF8PROC_CATEGORY_PO: /**< Punctuation, other */
-			case UTF8PROC_CATEGORY_SM: /**< Symbol, math */
-			case UTF8PROC_CATEGORY_SC: /**< Symbol, currency */
-			case UTF8PROC_CATEGORY_SK: /**< Symbol, modifier */
-			case UTF8PROC_CATEGORY_SO: /**< Symbol, other */
-			case UTF8PROC_CATEGORY_ZS: /**< Separator, space */
-			case UTF8PROC_CATEGORY_ZL: /**< Separator, line */
-			case UTF8PROC_CATEGORY_ZP: /**< Separator, paragraph */
-			{
-				if (token_byte_count == 0) {
-					return 0;
-				}
-
-				found_delimiter = tek_true;
-				break;
-			}
-
-			case UTF8PROC_CATEGORY_CC: /**< Other, control */
-				if (codept == U'\n' || codept == U'\r' || codept == U'\t') {
-					found_delimiter = tek_true;
-					break;
-				}
-				// fallthrough
-			case UTF8PROC_CATEGORY_MN: /**< Mark, nonspacing */
-			case UTF8PROC_CATEGORY_MC: /**< Mark, spacing combining */
-			case UTF8PROC_CATEGORY_ME: /**< Mark, enclosing */
-			case UTF8PROC_CATEGORY_CN: /**< Other, not assigned */
-			case UTF8PROC_CATEGORY_CF: /**< Other, format */
-			case UTF8PROC_CATEGORY_CS: /**< Other, surrogate */
-			case UTF8PROC_CATEGORY_CO: /**< Other, private use */
+		switch (TekLexerIdentClass_from_codept(codept)) {
+			case TekLexerIdentClass_invalid:
 				return 0;
-		}
-
-		if (found_delimiter) {
-			break;
+			case TekLexerIdentClass_delimiter:
+				return token_byte_count;
+			case TekLexerIdentClass_continue:
+				break;
 		}
 
 		token_byte_count += codept_byte_count;
-		if (token_byte_count >= remaining_count) {
-			break;
-		}
 	}
 
 	return token_byte_count;
@@ -110,13 +259,371 @@ static inline void _TekLexer_advance_line(TekLexer* lexer, TekFile* file) {
 
 	//printf("line %u: %.*s\n", lexer->line + 1, 10, lexer->code + lexer->code_idx);
 
-	uintptr_t* line_code_start_indices = TekFile_line_code_start_indices(file);
+	uintptr_t* line_code_start_indices = _TekFile_line_code_start_indices(file);
 	line_code_start_indices[file->lines_count] = lexer->code_idx;
 	file->lines_count += 1;
 	lexer->line += 1;
 	lexer->column = 1;
 }
 
+//
+// advances over the new line in a string and copies its bytes to the string buf, so a "\r\n" is kept whole.
+static inline void _TekLexer_string_buf_add_new_line(TekLexer* lexer, TekFile* file, char* string_buf, uintptr_t* string_buf_size_in_out) {
+	uint32_t code_idx = lexer->code_idx;
+	_TekLexer_advance_line(lexer, file);
+	for (; code_idx < lexer->code_idx; code_idx += 1) {
+		string_buf[*string_buf_size_in_out] = lexer->code[code_idx];
+		*string_buf_size_in_out += 1;
+	}
+}
+
+//
+// @return: the number of bytes from @param(pos) up to @param(end) that are equal to @param(byte).
+static inline uint32_t _TekLexer_count_run(uint8_t* pos, uint8_t* end, uint8_t byte) {
+	uint8_t* start = pos;
+#if TEK_LEXER_SIMD && defined(__AVX2__)
+	__m256i needle_32 = _mm256_set1_epi8(byte);
+	while (end - pos >= 32) {
+		__m256i bytes = _mm256_loadu_si256((__m256i*)pos);
+		uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, needle_32));
+		if (mask) return pos - start + __builtin_ctz(mask);
+		pos += 32;
+	}
+#endif
+#if TEK_LEXER_SIMD && defined(__SSE2__)
+	__m128i needle_16 = _mm_set1_epi8(byte);
+	while (end - pos >= 16) {
+		__m128i bytes = _mm_loadu_si128((__m128i*)pos);
+		uint32_t mask = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle_16)) & 0xffff;
+		if (mask) return pos - start + __builtin_ctz(mask);
+		pos += 16;
+	}
+#endif
+	while (pos < end && *pos == byte) {
+		pos += 1;
+	}
+	return pos - start;
+}
+
+//
+// @return: the number of bytes from @param(pos) up to @param(end) that come before
+//          the first byte that is equal to any of @param(a), @param(b), @param(c) or @param(d).
+//          repeat a byte if you want to look for less than four.
+static inline uint32_t _TekLexer_count_until_any(uint8_t* pos, uint8_t* end, uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+	uint8_t* start = pos;
+#if TEK_LEXER_SIMD && defined(__AVX2__)
+	__m256i a_32 = _mm256_set1_epi8(a);
+	__m256i b_32 = _mm256_set1_epi8(b);
+	__m256i c_32 = _mm256_set1_epi8(c);
+	__m256i d_32 = _mm256_set1_epi8(d);
+	while (end - pos >= 32) {
+		__m256i bytes = _mm256_loadu_si256((__m256i*)pos);
+		__m256i found = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(bytes, a_32), _mm256_cmpeq_epi8(bytes, b_32)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(bytes, c_32), _mm256_cmpeq_epi8(bytes, d_32)));
+		uint32_t mask = _mm256_movemask_epi8(found);
+		if (mask) return pos - start + __builtin_ctz(mask);
+		pos += 32;
+	}
+#endif
+#if TEK_LEXER_SIMD && defined(__SSE2__)
+	__m128i a_16 = _mm_set1_epi8(a);
+	__m128i b_16 = _mm_set1_epi8(b);
+	__m128i c_16 = _mm_set1_epi8(c);
+	__m128i d_16 = _mm_set1_epi8(d);
+	while (end - pos >= 16) {
+		__m128i bytes = _mm_loadu_si128((__m128i*)pos);
+		__m128i found = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, a_16), _mm_cmpeq_epi8(bytes, b_16)),
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, c_16), _mm_cmpeq_epi8(bytes, d_16)));
+		uint32_t mask = _mm_movemask_epi8(found);
+		if (mask) return pos - start + __builtin_ctz(mask);
+		pos += 16;
+	}
+#endif
+	while (pos < end) {
+		uint8_t byte = *pos;
+		if (byte == a || byte == b || byte == c || byte == d) break;
+		pos += 1;
+	}
+	return pos - start;
+}
+
+//
+// @return: the value of a digit that has already been validated for its radix.
+static inline uint32_t _TekLexer_digit_value(uint8_t byte) {
+	return byte <= '9' ? byte - '0' : (byte | 0x20) - 'a' + 10;
+}
+
+//
+// @return: the value of 8 decimal digits loaded in to a uint64_t, the first digit is in the lowest byte.
+static inline uint64_t _TekLexer_swar_dec_8(uint64_t chunk) {
+	chunk -= 0x3030303030303030;
+	chunk = ((chunk * 10) + (chunk >> 8)) & 0x00ff00ff00ff00ff;
+	chunk = ((chunk * 100) + (chunk >> 16)) & 0x0000ffff0000ffff;
+	return ((chunk * 10000) + (chunk >> 32)) & 0xffffffff;
+}
+
+//
+// @return: the value of 8 hex digits loaded in to a uint64_t, the first digit is in the lowest byte.
+static inline uint64_t _TekLexer_swar_hex_8(uint64_t chunk) {
+	// '0'-'9' have 0 in bit 6 and 'a'-'f' and 'A'-'F' have 1 in bit 6 with 1-6 in the low nibble.
+	chunk = (chunk & 0x0f0f0f0f0f0f0f0f) + ((chunk >> 6) & 0x0101010101010101) * 9;
+	chunk = ((chunk << 4) | (chunk >> 8)) & 0x00ff00ff00ff00ff;
+	chunk = ((chunk << 8) | (chunk >> 16)) & 0x0000ffff0000ffff;
+	return ((chunk << 16) | (chunk >> 32)) & 0xffffffff;
+}
+
+//
+// parses the digits of an integer literal that have already been validated for the @param(radix).
+// 19 decimal digits and 16 hex digits always fit in 64 bits, so these are parsed 8 digits at a time without any overflow checks.
+// everything else goes through a digit by digit loop that checks for overflow.
+//
+// @return: tek_false if the value does not fit in 64 bits
+static TekBool _TekLexer_parse_uint(char* digits, uint32_t digits_count, uint8_t radix, uint64_t* value_out) {
+	uint32_t idx = 0;
+	while (idx < digits_count && digits[idx] == '0') {
+		idx += 1;
+	}
+
+	uint64_t value = 0;
+#if TEK_LEXER_SIMD && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint32_t remaining_count = digits_count - idx;
+	if (radix == 10 && remaining_count <= 19) {
+		for (; digits_count - idx >= 8; idx += 8) {
+			uint64_t chunk;
+			memcpy(&chunk, &digits[idx], sizeof(chunk));
+			value = value * 100000000 + _TekLexer_swar_dec_8(chunk);
+		}
+		for (; idx < digits_count; idx += 1) {
+			value = value * 10 + (digits[idx] - '0');
+		}
+		*value_out = value;
+		return tek_true;
+	}
+
+	if (radix == 16 && remaining_count <= 16) {
+		for (; digits_count - idx >= 8; idx += 8) {
+			uint64_t chunk;
+			memcpy(&chunk, &digits[idx], sizeof(chunk));
+			value = (value << 32) | _TekLexer_swar_hex_8(chunk);
+		}
+		for (; idx < digits_count; idx += 1) {
+			value = (value << 4) | _TekLexer_digit_value(digits[idx]);
+		}
+		*value_out = value;
+		return tek_true;
+	}
+#endif
+
+	for (; idx < digits_count; idx += 1) {
+		if (
+			__builtin_mul_overflow(value, radix, &value) ||
+			__builtin_add_overflow(value, _TekLexer_digit_value(digits[idx]), &value)
+		) {
+			return tek_false;
+		}
+	}
+	*value_out = value;
+	return tek_true;
+}
+
+//
+// the 128 most significant bits of every power of ten a double can have, rounded down.
+// this is generated by build_script.c.
+#include "tek_pow10_table.h"
+
+//
+// the powers of ten that are exact in a double.
+static double TekLexerPow10_exact[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+//
+// works out the correctly rounded double of @param(mantissa) * 10^@param(exp10) using the Eisel-Lemire algorithm.
+// the mantissa is multiplied by the 128-bit approximation of the power of ten, which is enough
+// to know how to round in all but a few cases that are too close to halfway between two doubles.
+// subnormals and infinity are left to the caller as well.
+//
+// @return: tek_false if the result could not be worked out here
+static TekBool _TekLexer_eisel_lemire(uint64_t mantissa, int32_t exp10, TekBool is_negative, double* value_out) {
+	if (exp10 < TekLexerPow10_min_exp10 || exp10 > TekLexerPow10_max_exp10) {
+		return tek_false;
+	}
+
+	//
+	// normalize the mantissa so its top bit is set like the power of ten's.
+	// 217706 / 2^16 is log2(10), so this is the binary exponent of the result before normalizing.
+	uint32_t leading_zeros = __builtin_clzll(mantissa);
+	mantissa <<= leading_zeros;
+	uint64_t exp2 = (uint64_t)(((217706 * exp10) >> 16) + 64 + 1023) - leading_zeros;
+
+	uint64_t* pow10 = TekLexerPow10_table[exp10 - TekLexerPow10_min_exp10];
+	__uint128_t product = (__uint128_t)mantissa * pow10[0];
+	uint64_t product_hi = product >> 64;
+	uint64_t product_lo = product;
+
+	//
+	// when the bits below the 54 we keep are all ones, the rounded down power of ten may have lost a carry in to them.
+	// so bring in the lower 64 bits of the power of ten to be sure.
+	if ((product_hi & 0x1ff) == 0x1ff && product_lo + mantissa < mantissa) {
+		__uint128_t lower = (__uint128_t)mantissa * pow10[1];
+		uint64_t lower_hi = lower >> 64;
+		uint64_t merged_hi = product_hi;
+		uint64_t merged_lo = product_lo + lower_hi;
+		if (merged_lo < product_lo) {
+			merged_hi += 1;
+		}
+		if ((merged_hi & 0x1ff) == 0x1ff && merged_lo + 1 == 0 && (uint64_t)lower + mantissa < mantissa) {
+			return tek_false;
+		}
+		product_hi = merged_hi;
+		product_lo = merged_lo;
+	}
+
+	//
+	// keep 54 bits, one more than a double has so we can round to nearest.
+	uint64_t msb = product_hi >> 63;
+	uint64_t bits = product_hi >> (msb + 9);
+	exp2 -= 1 ^ msb;
+
+	// exactly halfway, which way to round depends on bits the approximation does not have.
+	if (product_lo == 0 && (product_hi & 0x1ff) == 0 && (bits & 3) == 1) {
+		return tek_false;
+	}
+
+	bits += bits & 1;
+	bits >>= 1;
+	if (bits >> 53) {
+		bits >>= 1;
+		exp2 += 1;
+	}
+
+	// subnormal, infinity or NaN
+	if (exp2 - 1 >= 0x7ff - 1) {
+		return tek_false;
+	}
+
+	bits = (exp2 << 52) | (bits & 0x000fffffffffffff) | ((uint64_t)is_negative << 63);
+	memcpy(value_out, &bits, sizeof(bits));
+	return tek_true;
+}
+
+//
+// parses a float literal that has already been validated, this has an optional minus sign and a single decimal point.
+// the significant digits are parsed in to a uint64_t and then converted with an exact
+// double operation when possible, otherwise with the Eisel-Lemire algorithm.
+//
+// @return: tek_false if the result could not be worked out here, the caller must fall back to strtod
+static TekBool _TekLexer_parse_float(char* chars, uint32_t chars_count, double* value_out) {
+	TekBool is_negative = chars[0] == '-';
+	uint32_t start = is_negative;
+	uint32_t point_idx = start;
+	while (chars[point_idx] != '.') {
+		point_idx += 1;
+	}
+
+	//
+	// leading and trailing zeros are not significant, the trailing ones are moved in to the exponent.
+	while (start < chars_count && (chars[start] == '0' || chars[start] == '.')) {
+		start += 1;
+	}
+	uint32_t end = chars_count;
+	while (end > start && (chars[end - 1] == '0' || chars[end - 1] == '.')) {
+		end -= 1;
+	}
+	if (start == end) {
+		*value_out = is_negative ? -0.0 : 0.0;
+		return tek_true;
+	}
+
+	// 19 digits always fit in a uint64_t
+	uint64_t mantissa = 0;
+	uint32_t digits_count = 0;
+	for (uint32_t idx = start; idx < end; idx += 1) {
+		if (chars[idx] == '.') continue;
+		if (digits_count == 19) return tek_false;
+		mantissa = mantissa * 10 + (chars[idx] - '0');
+		digits_count += 1;
+	}
+	int32_t exp10 = end <= point_idx ? (int32_t)(point_idx - end) : (int32_t)(point_idx + 1) - (int32_t)end;
+
+	//
+	// both the mantissa and the power of ten are exact in a double,
+	// so a single multiply or divide is correctly rounded.
+	if (mantissa <= (1ull << 53) && exp10 >= -22 && exp10 <= 22) {
+		double value = (double)mantissa;
+		value = exp10 < 0 ? value / TekLexerPow10_exact[-exp10] : value * TekLexerPow10_exact[exp10];
+		*value_out = is_negative ? -value : value;
+		return tek_true;
+	}
+
+	return _TekLexer_eisel_lemire(mantissa, exp10, is_negative, value_out);
+}
+
+//
+// @return: the index of the first byte from @param(code) that is not part of a valid UTF-8 codepoint, or @param(size) if they all are.
+//          overlong encodings, surrogates and codepoints past U+10FFFF are not valid.
+static uintptr_t _TekLexer_utf8_validate(uint8_t* code, uintptr_t size) {
+	uintptr_t idx = 0;
+	while (1) {
+		//
+		// nearly all source code is ASCII, so skip over it a vector at a time.
+		// the first byte that has the top bit set is then found by the scalar loop.
+#if TEK_LEXER_SIMD && defined(__AVX2__)
+		while (size - idx >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256((__m256i*)&code[idx])) == 0) {
+			idx += 32;
+		}
+#endif
+#if TEK_LEXER_SIMD && defined(__SSE2__)
+		while (size - idx >= 16 && _mm_movemask_epi8(_mm_loadu_si128((__m128i*)&code[idx])) == 0) {
+			idx += 16;
+		}
+#endif
+		while (idx < size && code[idx] < 0x80) {
+			idx += 1;
+		}
+		if (idx == size) {
+			break;
+		}
+
+		uint8_t byte = code[idx];
+		uint32_t codept_byte_count;
+		int32_t codept_min;
+		if ((byte & 0xe0) == 0xc0) {
+			codept_byte_count = 2;
+			codept_min = 0x80;
+		} else if ((byte & 0xf0) == 0xe0) {
+			codept_byte_count = 3;
+			codept_min = 0x800;
+		} else if ((byte & 0xf8) == 0xf0) {
+			codept_byte_count = 4;
+			codept_min = 0x10000;
+		} else {
+			return idx;
+		}
+		if (size - idx < codept_byte_count) {
+			return idx;
+		}
+
+		int32_t codept = byte & (0x7f >> codept_byte_count);
+		for (uint32_t i = 1; i < codept_byte_count; i += 1) {
+			byte = code[idx + i];
+			if ((byte & 0xc0) != 0x80) {
+				return idx;
+			}
+			codept = (codept << 6) | (byte & 0x3f);
+		}
+		if (codept < codept_min || codept > 0x10ffff || (codept >= 0xd800 && codept <= 0xdfff)) {
+			return idx;
+		}
+		idx += codept_byte_count;
+	}
+
+	return size;
+}
+
 #define _TekLexer_compare_consume_lit(lexer, str) _TekLexer_compare_consume(lexer, str, sizeof(str) - 1)
 static TekBool _TekLexer_compare_consume(TekLexer* lexer, char* str, uint32_t str_len) {
 	char* cursor = lexer->code + lexer->code_idx;
@@ -132,18 +639,16 @@ static TekBool _TekLexer_compare_consume(TekLexer* lexer, char* str, uint32_t st
 	return tek_true;
 }
 
-void TekLexer_token_add(TekLexer* lexer, TekFile* file, TekToken token, uint32_t code_idx_start, uint32_t code_idx_end, uint32_t line_start, uint32_t column_start) {
-	TekTokenLoc* token_locs = TekFile_token_locs(file);
+void TekLexer_token_add(TekLexer* lexer, TekFile* file, TekToken token, uint32_t code_idx_start, uint32_t code_idx_end) {
+	TekTokenLocCompact* token_locs = _TekFile_token_locs(file);
 	TekToken* tokens = TekFile_tokens(file);
 
 	//
 	// insert the token and it's location into the arrays
 	uint32_t insert_idx = file->tokens_count;
-	token_locs[insert_idx] = (TekTokenLoc) {
+	token_locs[insert_idx] = (TekTokenLocCompact) {
 		.code_idx_start = code_idx_start,
 		.code_idx_end = code_idx_end,
-		.line = line_start,
-		.column = column_start,
 	};
 
 	tokens[insert_idx] = token;
@@ -159,21 +664,48 @@ void TekToken_as_string(TekToken token, char* string_out, uint32_t string_out_si
 	}
 }
 
-TekBool TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFileId file_id) {
-	TekTokenOpenBracket open_brackets[tek_lexer_cap_open_brackets] = {0};
-	uint32_t open_brackets_count = 0;
-
-	//
-	// reset the lexer
-	tek_zero_elmt(lexer);
+//
+// the old tokens of a file that TekLexer_relex is lexing towards.
+// the new tokens are lexed into the spare space past the end of the old ones,
+// so the old ones are left where they are until the new ones line up with them.
+typedef struct TekLexerResync TekLexerResync;
+struct TekLexerResync {
+	// the file's own tokens and token locations, where the old tokens are
+	TekToken* old_tokens;
+	TekTokenLocCompact* old_token_locs;
+	// new tokens that start before this are in or before the edit, so they cannot match an old token.
+	uintptr_t edit_end_code_idx;
+	// how far the code after the edit has moved
+	intptr_t code_idx_shift;
+	// the shift that is still to be added to the old token locations, see TekFile.relex_code_idx_shift
+	uint32_t old_code_idx_shift;
+	// the first new token. the brackets that are open before it are matched up by TekLexer_relex,
+	// as their tokens are not in the spare space.
+	uint32_t restart_token_idx;
+	// the old tokens that have not been matched yet
+	uint32_t old_token_idx;
+	uint32_t old_tokens_end_idx;
+	// the lexing stops once the new tokens or values reach these, as past them there is no room to splice them in.
+	uint32_t tokens_cap;
+	uint32_t values_cap;
+	// set once a new token has matched an old one
+	TekBool is_synced;
+	// set when the lexing was stopped by tokens_cap or values_cap
+	TekBool is_out_of_room;
+};
+
+static TekBool _TekLexer_resync_check(TekFile* file, TekLexerResync* resync);
+
+//
+// lexes from lexer->code_idx to the end of the code, appending to the file's arrays.
+// the lexer, open_brackets and the file's counts must already be setup for the code before lexer->code_idx.
+// when @param(resync) is not NULL, the lexing stops as soon as a new token matches an old one,
+// and @param(file) is a copy of the file that TekLexer_relex has pointed at its spare space.
+// @return: tek_false if an error was added to the compiler
+static TekBool _TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFile* file, TekTokenOpenBracket* open_brackets, uint32_t* open_brackets_count_in_out, TekLexerResync* resync) {
+	uint32_t open_brackets_count = *open_brackets_count_in_out;
 	TekError error = {0};
-
-	TekFile* file = TekCompiler_file_get(c, file_id);
-
-	//
-	// setup the lexer to use the file
-	lexer->code = file->code;
-	lexer->code_len = file->size;
+	TekFileId file_id = file->id;
 
 #define bail(kind_) \
 	{ \
@@ -181,33 +713,63 @@ TekBool TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFileId file_id) {
 		goto BAIL; \
 	}
 
-	uint32_t code_idx_start, line_start, column_start;
+	uint32_t code_idx_start;
 	char num_buf[128];
 	TekToken open_variant;
 	TekBool is_signed;
 	TekToken token;
-	TekTokenLoc* token_locs = TekFile_token_locs(file);
+	TekTokenLocCompact* token_locs = _TekFile_token_locs(file);
 	TekToken* tokens = TekFile_tokens(file);
 	TekValue* token_values = TekFile_token_values(file);
-	uintptr_t* line_code_start_indices = TekFile_line_code_start_indices(file);
+	uint32_t* bracket_matches = TekFile_bracket_matches(file);
+	uintptr_t* line_code_start_indices = _TekFile_line_code_start_indices(file);
 	char* string_buf = TekFile_string_buf(file);
 	uintptr_t string_buf_size;
+	uint8_t* code_end = (uint8_t*)lexer->code + lexer->code_len;
+
+#if TEK_LEXER_VALIDATE_UTF8
+	{
+		//
+		// when relexing, only the code from the restart up to the end of the edit can be new.
+		// the validation goes on past any continuation bytes, so a codepoint that the edit split apart is caught.
+		uintptr_t validate_end_idx = lexer->code_len;
+		if (resync && resync->edit_end_code_idx < validate_end_idx) {
+			validate_end_idx = resync->edit_end_code_idx;
+			while (validate_end_idx < lexer->code_len && ((uint8_t)lexer->code[validate_end_idx] & 0xc0) == 0x80) {
+				validate_end_idx += 1;
+			}
+		}
+
+		uintptr_t validate_len = validate_end_idx - lexer->code_idx;
+		uintptr_t invalid_code_idx = lexer->code_idx + _TekLexer_utf8_validate((uint8_t*)lexer->code + lexer->code_idx, validate_len);
+		if (invalid_code_idx != validate_end_idx) {
+			//
+			// add the new line start indices up to the invalid byte,
+			// the rest are added after bailing.
+			while (lexer->code_idx < invalid_code_idx) {
+				uint8_t byte = _TekLexer_peek_byte(lexer);
+				if (byte == '\r' || byte == '\n') {
+					_TekLexer_advance_line(lexer, file);
+				} else {
+					_TekLexer_advance_column(lexer, 1);
+				}
+			}
+			token = 0;
+			code_idx_start = lexer->code_idx;
+			_TekLexer_advance_column(lexer, 1);
+			bail(TekErrorKind_lexer_invalid_utf8);
+		}
+	}
+#endif
+
 	while (_TekLexer_has_code(lexer)) {
 		token = _TekLexer_peek_byte(lexer);
 		code_idx_start = lexer->code_idx;
-		line_start = lexer->line;
-		column_start = lexer->column;
 
 		switch (token) {
 			case ' ':
-				// TODO: legend has it... we can use SIMD to speed this up.
-				do { _TekLexer_advance_column(lexer, 1); }
-					while (_TekLexer_has_code(lexer) && _TekLexer_peek_byte(lexer) == ' ');
-				continue;
 			case '\t':
-				// TODO: legend has it... we can use SIMD to speed this up.
-				do { _TekLexer_advance_column(lexer, 1); }
-					while (_TekLexer_has_code(lexer) && _TekLexer_peek_byte(lexer) == '\t');
+				_TekLexer_advance_column(lexer, _TekLexer_count_run((uint8_t*)lexer->code + lexer->code_idx, code_end, token));
 				continue;
 			//
 			// simple ascii symbols that are not the start of a grouped symbol
@@ -219,12 +781,6 @@ TekBool TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFileId file_id) {
 			case '\\':
 				break;
 
-			case '.':
-				if (_TekLexer_compare_consume_lit(lexer, "...")) token = TekToken_ellipsis;
-				else if (_TekLexer_compare_consume_lit(lexer, "..=")) token = TekToken_double_full_stop_equal;
-				else if (_TekLexer_compare_consume_lit(lexer, "..")) token = TekToken_double_full_stop;
-				break;
-
 			//
 			// any of the newline terminators
 			case ';':
@@ -242,7 +798,7 @@ NEW_LINE_END:
 				//
 				// block comment will allow a newline to be made twice, so combine them if this happens.
 				if (file->tokens_count > 0 && tokens[file->tokens_count - 1] == '\n') {
-					TekTokenLoc* prev_loc = &token_locs[file->tokens_count - 1];
+					TekTokenLocCompact* prev_loc = &token_locs[file->tokens_count - 1];
 					prev_loc->code_idx_end = lexer->code_idx;
 					continue;
 				}
@@ -276,6 +832,12 @@ CHECK_CLOSE_BRACKET:
 					goto BAIL_INCORRECT_CLOSE_BRACKET;
 				}
 				open_brackets_count -= 1;
+				uint32_t open_token_idx = open_brackets[open_brackets_count].token_idx;
+				uint32_t distance = file->tokens_count - open_token_idx;
+				bracket_matches[file->tokens_count] = distance;
+				if (tek_likely(resync == NULL) || open_token_idx >= resync->restart_token_idx) {
+					bracket_matches[open_token_idx] = distance;
+				}
 				break;
 			};
 
@@ -402,32 +964,44 @@ NUM_ANALYZE_END: {}
 				num_buf[num_buf_count] = '\0';
 				TekValue* value = &token_values[file->token_values_count];
 				file->token_values_count += 1;
-				char* end_ptr = NULL;
 				switch (token) {
 					case TekToken_lit_uint:
-						value->uint = strtoul(num_buf, &end_ptr, radix);
-						if ((value->uint == 0 || value->uint == ULONG_MAX) && errno == ERANGE) {
+						if (!_TekLexer_parse_uint(num_buf, num_buf_count, radix, &value->uint)) {
 							goto NUM_OVERFLOW;
 						}
 						break;
-					case TekToken_lit_sint:
-						value->sint = strtol(num_buf, &end_ptr, radix);
-						if ((value->sint == LONG_MIN || value->sint == LONG_MAX) && errno == ERANGE) {
+					case TekToken_lit_sint: {
+						//
+						// parse the digits after the minus sign, the magnitude of the minimum
+						// signed integer is one more than the maximum.
+						uint64_t magnitude;
+						if (
+							!_TekLexer_parse_uint(num_buf + 1, num_buf_count - 1, radix, &magnitude) ||
+							magnitude > (uint64_t)INT64_MAX + 1
+						) {
 							goto NUM_OVERFLOW;
 						}
+						value->uint = 0 - magnitude;
 						break;
-					case TekToken_lit_float:
+					};
+					case TekToken_lit_float: {
+						if (_TekLexer_parse_float(num_buf, num_buf_count, &value->float_)) {
+							break;
+						}
+
+						char* end_ptr = NULL;
+						errno = 0;
 						value->float_ = strtod(num_buf, &end_ptr);
 						if ((value->float_ == -HUGE_VAL || value->float_ == HUGE_VAL) && errno == ERANGE) {
 							goto NUM_OVERFLOW;
 						}
+						if (end_ptr - num_buf != num_buf_count) {
+							goto NUM_OVERFLOW;
+						}
 						break;
+					};
 					default: tek_abort("only expected uint, sint or float tokens");
 				}
-
-				if (end_ptr - num_buf != num_buf_count) {
-					goto NUM_OVERFLOW;
-				}
 				break;
 			};
 
@@ -443,6 +1017,21 @@ NUM_ANALYZE_END: {}
 				// error: unclosed string literal right at the end of the file
 				if (!_TekLexer_has_code(lexer)) { bail(TekErrorKind_lexer_unclosed_string_literal); }
 
+				//
+				// most strings are on a single line and have no escape codes, so there is nothing to process.
+				// these are interned straight from the code without copying them to the string buf.
+				// anything else is processed from the start of the string below.
+				{
+					char* str = lexer->code + lexer->code_idx;
+					uint32_t str_len = _TekLexer_count_until_any((uint8_t*)str, code_end, '"', '\\', '\r', '\n');
+					if (lexer->code_idx + str_len < lexer->code_len && str[str_len] == '"') {
+						_TekLexer_advance_column(lexer, str_len + 1);
+						TekValue* value = &token_values[file->token_values_count];
+						file->token_values_count += 1;
+						value->str_id = TekCompiler_strtab_get_or_insert(c, str, str_len);
+						break;
+					}
+				}
 
 				uint8_t byte = _TekLexer_peek_byte(lexer);
 				TekBool allow_new_line = tek_false;
@@ -459,9 +1048,7 @@ NUM_ANALYZE_END: {}
 						if (!_TekLexer_has_code(lexer)) bail(TekErrorKind_lexer_unclosed_string_literal);
 						byte = _TekLexer_peek_byte(lexer);
 						if (byte == '\r' || byte == '\n') {
-							_TekLexer_advance_line(lexer, file);
-							string_buf[string_buf_size] = byte;
-							string_buf_size += 1;
+							_TekLexer_string_buf_add_new_line(lexer, file, string_buf, &string_buf_size);
 							indent_char = _TekLexer_peek_byte(lexer);
 						} else if (byte == ' ' || byte == '\t') {
 							if (byte != indent_char)
@@ -485,9 +1072,7 @@ NUM_ANALYZE_END: {}
 							byte = _TekLexer_peek_byte(lexer);
 							if (byte == '"') break;
 							if (byte == '\r' || byte == '\n') {
-								_TekLexer_advance_line(lexer, file);
-								string_buf[string_buf_size] = byte;
-								string_buf_size += 1;
+								_TekLexer_string_buf_add_new_line(lexer, file, string_buf, &string_buf_size);
 							} else if (byte == ' ' || byte == '\t') {
 								if (byte != indent_char) {
 									error.kind = TekErrorKind_lexer_multiline_string_indent_different_char;
@@ -501,10 +1086,9 @@ STRING_ERR:
 								error.args[1].file_id = file_id;
 								error.args[1].token_idx = file->tokens_count;
 								code_idx_start = line_code_start_indices[indent_line - 1];
-								TekLexer_token_add(lexer, file, 0, code_idx_start, code_idx_start + newline_ignore_whitespace_upto - 1, indent_line, 1);
+								TekLexer_token_add(lexer, file, 0, code_idx_start, code_idx_start + newline_ignore_whitespace_upto - 1);
 
-								code_idx_start = line_code_start_indices[indent_line - 1];
-								line_start = lexer->line;
+								code_idx_start = line_code_start_indices[lexer->line - 1];
 								bail(error.kind);
 							}
 						}
@@ -537,7 +1121,7 @@ STRING_ERR:
 							code_idx_start = lexer->code_idx;
 							bail(TekErrorKind_lexer_new_line_in_a_single_line_string);
 						}
-						_TekLexer_advance_line(lexer, file);
+						_TekLexer_string_buf_add_new_line(lexer, file, string_buf, &string_buf_size);
 						goto STRING_CONTINUE;
 					} else if (byte == '\\') { // escape codes
 						_TekLexer_advance_column(lexer, 1);
@@ -577,7 +1161,7 @@ STRING_ERR:
 
 									// if first digit move over to the next hex column
 									if (i == 0)
-										byte = (byte - '0') * 16;
+										byte *= 16;
 								}
 								break;
 							default:
@@ -586,6 +1170,8 @@ STRING_ERR:
 						}
 					}
 
+					string_buf[string_buf_size] = byte;
+					string_buf_size += 1;
 					_TekLexer_advance_column(lexer, 1);
 STRING_CONTINUE: {}
 					if (!_TekLexer_has_code(lexer)) { bail(TekErrorKind_lexer_unclosed_string_literal); }
@@ -602,16 +1188,34 @@ STRING_CONTINUE: {}
 			//
 			// symbols & grouped symbols
 			//
-			case '+': {
-				if (_TekLexer_compare_consume_lit(lexer, "+=")) token = TekToken_assign_add;
-				else if (_TekLexer_compare_consume_lit(lexer, "++")) token = TekToken_concat;
-				else if (_TekLexer_compare_consume_lit(lexer, "++=")) token = TekToken_assign_concat;
+			case '.':
+			case '+':
+			case '*':
+			case '%':
+			case '!':
+			case '&':
+			case '|':
+			case '^':
+			case '<':
+			case '>':
+			case '=':
+			case '?':
+TOKEN_OP: {
+				//
+				// a single byte operator keeps its byte as the token and is advanced over at TOKEN_END.
+				TekLexerOp* op = TekLexerOp_find((uint8_t*)lexer->code + lexer->code_idx, code_end);
+				if (op) {
+					token = op->token;
+					_TekLexer_advance_column(lexer, op->len);
+				}
 				break;
 			};
 			case '-': {
-				if (_TekLexer_compare_consume_lit(lexer, "-=")) token = TekToken_assign_subtract;
-				else if (_TekLexer_compare_consume_lit(lexer, "->")) token = TekToken_right_arrow;
-				else if (lexer->code_idx + 1 < lexer->code_len) {
+				TekLexerOp* op = TekLexerOp_find((uint8_t*)lexer->code + lexer->code_idx, code_end);
+				if (op) {
+					token = op->token;
+					_TekLexer_advance_column(lexer, op->len);
+				} else if (lexer->code_idx + 1 < lexer->code_len) {
 					uint8_t next_byte = lexer->code[lexer->code_idx + 1];
 					if (next_byte >= '0' && next_byte <= '9') {
 						// special case where the minus is used to represent a negative number literal
@@ -622,29 +1226,16 @@ STRING_CONTINUE: {}
 				}
 				break;
 			};
-			case '*': {
-				if (_TekLexer_compare_consume_lit(lexer, "*=")) token = TekToken_assign_multiply;
-				break;
-			};
 			case '/': {
-				if (_TekLexer_compare_consume_lit(lexer, "/=")) {
-					token = TekToken_assign_divide;
-				} else if (_TekLexer_compare_consume_lit(lexer, "//")) { // line comment
+				if (_TekLexer_compare_consume_lit(lexer, "//")) { // line comment
 					//
 					// skip over every character that comes before the next new line.
 					// this is so the new line get tokenized on the next iteration.
 					// but we skip over the new line if the previous token was a new line.
 					//
-					uint8_t byte = '\0';
-					while (_TekLexer_has_code(lexer)) {
-						byte = _TekLexer_peek_byte(lexer);
-						if (byte == '\n' || byte == '\r') {
-							if (file->tokens_count > 0 && tokens[file->tokens_count - 1] == '\n') {
-								_TekLexer_advance_line(lexer, file);
-							}
-							break;
-						}
-						_TekLexer_advance_column(lexer, 1);
+					_TekLexer_advance_column(lexer, _TekLexer_count_until_any((uint8_t*)lexer->code + lexer->code_idx, code_end, '\n', '\r', '\n', '\r'));
+					if (_TekLexer_has_code(lexer) && file->tokens_count > 0 && tokens[file->tokens_count - 1] == '\n') {
+						_TekLexer_advance_line(lexer, file);
 					}
 
 					// line comment is not a token, so continue
@@ -661,6 +1252,16 @@ STRING_CONTINUE: {}
 							lexer->code_idx = code_idx_start + 2;
 							bail(TekErrorKind_lexer_unclosed_block_comment);
 						}
+
+						//
+						// jump over the bytes that cannot start or end a comment or a line.
+						uint32_t skip_count = _TekLexer_count_until_any((uint8_t*)lexer->code + lexer->code_idx, code_end, '*', '/', '\r', '\n');
+						if (skip_count) {
+							_TekLexer_advance_column(lexer, skip_count);
+							last_byte = '\0';
+							continue;
+						}
+
 						uint8_t byte = _TekLexer_peek_byte(lexer);
 						if (last_byte == '/' && byte == '*') {
 							nested_count += 1;
@@ -686,49 +1287,7 @@ STRING_CONTINUE: {}
 					// block comment is not a token, so continue
 					continue;
 				}
-				break;
-			};
-			case '%': {
-				if (_TekLexer_compare_consume_lit(lexer, "%=")) token = TekToken_assign_remainder;
-				break;
-			};
-			case '!': {
-				if (_TekLexer_compare_consume_lit(lexer, "!=")) token = TekToken_not_equal;
-				break;
-			};
-			case '&': {
-				if (_TekLexer_compare_consume_lit(lexer, "&&")) token = TekToken_double_ampersand;
-				else if (_TekLexer_compare_consume_lit(lexer, "&=")) token = TekToken_assign_bit_and;
-				break;
-			};
-			case '|': {
-				if (_TekLexer_compare_consume_lit(lexer, "||")) token = TekToken_double_pipe;
-				else if (_TekLexer_compare_consume_lit(lexer, "|=")) token = TekToken_assign_bit_or;
-				break;
-			};
-			case '^':
-				if (_TekLexer_compare_consume_lit(lexer, "^=")) token = TekToken_assign_bit_xor;
-				break;
-			case '<': {
-				if (_TekLexer_compare_consume_lit(lexer, "<=")) token = TekToken_greater_than_or_eq;
-				else if (_TekLexer_compare_consume_lit(lexer, "<<=")) token = TekToken_assign_bit_shift_left;
-				else if (_TekLexer_compare_consume_lit(lexer, "<<")) token = TekToken_double_greater_than;
-				break;
-			};
-			case '>': {
-				if (_TekLexer_compare_consume_lit(lexer, ">=")) token = TekToken_less_than_or_eq;
-				else if (_TekLexer_compare_consume_lit(lexer, ">>=")) token = TekToken_assign_bit_shift_right;
-				else if (_TekLexer_compare_consume_lit(lexer, ">>")) token = TekToken_double_less_than;
-				break;
-			};
-			case '=': {
-				if (_TekLexer_compare_consume_lit(lexer, "==")) token = TekToken_double_equal;
-				else if (_TekLexer_compare_consume_lit(lexer, "=>")) token = TekToken_thick_right_arrow;
-				break;
-			};
-			case '?': {
-				if (_TekLexer_compare_consume_lit(lexer, "?!")) token = TekToken_question_and_exclamation_mark;
-				break;
+				goto TOKEN_OP;
 			};
 			case '$': {
 				if (_TekLexer_compare_consume_lit(lexer, "$if")) token = TekToken_compile_time_if;
@@ -771,7 +1330,7 @@ STRING_CONTINUE: {}
 				TekBool is_directive = token == '#';
 				if (is_directive) {
 					// put the cursor back on the #
-					// so we can compare with it in the strings below.
+					// so it is part of the keyword lookup below.
 					lexer->code_idx -= 1;
 					lexer->column -= 1;
 					ident_len += 1;
@@ -785,125 +1344,9 @@ STRING_CONTINUE: {}
 				if (token == '\'') {
 					token = TekToken_label;
 				} else { // else identifier or directive
-					token = TekToken_ident;
-					switch (ident_len) {
-						case 2:
-							if (_TekLexer_compare_consume_lit(lexer, "if")) {
-								token = TekToken_if;
-							} else if (_TekLexer_compare_consume_lit(lexer, "as")) {
-								token = TekToken_as;
-							} else if (_TekLexer_compare_consume_lit(lexer, "in")) {
-								token = TekToken_in;
-							}
-							break;
-						case 3:
-							if (_TekLexer_compare_consume_lit(lexer, "var")) {
-								token = TekToken_var;
-							} else if (_TekLexer_compare_consume_lit(lexer, "mut")) {
-								token = TekToken_mut;
-							} else if (_TekLexer_compare_consume_lit(lexer, "mod")) {
-								token = TekToken_mod;
-							} else if (_TekLexer_compare_consume_lit(lexer, "for")) {
-								token = TekToken_for;
-							} else if (_TekLexer_compare_consume_lit(lexer, "lib")) {
-								token = TekToken_lib;
-							}
-							break;
-						case 4:
-							if (_TekLexer_compare_consume_lit(lexer, "else")) {
-								token = TekToken_else;
-							} else if (_TekLexer_compare_consume_lit(lexer, "proc")) {
-								token = TekToken_proc;
-							} else if (_TekLexer_compare_consume_lit(lexer, "case")) {
-								token = TekToken_case;
-							} else if (_TekLexer_compare_consume_lit(lexer, "loop")) {
-								token = TekToken_loop;
-							} else if (_TekLexer_compare_consume_lit(lexer, "enum")) {
-								token = TekToken_enum;
-							} else if (_TekLexer_compare_consume_lit(lexer, "goto")) {
-								token = TekToken_goto;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#abi")) {
-								token = TekToken_directive_abi;
-							}
-							break;
-						case 5:
-							if (_TekLexer_compare_consume_lit(lexer, "defer")) {
-								token = TekToken_defer;
-							} else if (_TekLexer_compare_consume_lit(lexer, "match")) {
-								token = TekToken_match;
-							} else if (_TekLexer_compare_consume_lit(lexer, "union")) {
-								token = TekToken_union;
-							} else if (_TekLexer_compare_consume_lit(lexer, "alias")) {
-								token = TekToken_alias;
-							} else if (_TekLexer_compare_consume_lit(lexer, "macro")) {
-								token = TekToken_macro;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#type")) {
-								token = TekToken_directive_type;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#expr")) {
-								token = TekToken_directive_expr;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#stmt")) {
-								token = TekToken_directive_stmt;
-							}
-							break;
-						case 6:
-							if (_TekLexer_compare_consume_lit(lexer, "return")) {
-								token = TekToken_return;
-							} else if (_TekLexer_compare_consume_lit(lexer, "struct")) {
-								token = TekToken_struct;
-							} else if (_TekLexer_compare_consume_lit(lexer, "interf")) {
-								token = TekToken_interf;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#error")) {
-								token = TekToken_directive_error;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#flags")) {
-								token = TekToken_directive_flags;
-							}
-							break;
-						case 7:
-							if (_TekLexer_compare_consume_lit(lexer, "#import")) {
-								token = TekToken_directive_import;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#inline")) {
-								token = TekToken_directive_inline;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#extern")) {
-								token = TekToken_directive_extern;
-							}
-							break;
-						case 8:
-							if (_TekLexer_compare_consume_lit(lexer, "continue")) {
-								token = TekToken_continue;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#noalias")) {
-								token = TekToken_directive_noalias;
-							}
-							break;
-						case 9:
-							if (_TekLexer_compare_consume_lit(lexer, "#bitfield")) {
-								token = TekToken_directive_bitfield;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#distinct")) {
-								token = TekToken_directive_distinct;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#noreturn")) {
-								token = TekToken_directive_noreturn;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#volatile")) {
-								token = TekToken_directive_volatile;
-							}
-							break;
-						case 10:
-							if (_TekLexer_compare_consume_lit(lexer, "#call_conv")) {
-								token = TekToken_directive_call_conv;
-							} else if (_TekLexer_compare_consume_lit(lexer, "#intrinsic")) {
-								token = TekToken_directive_intrinsic;
-							}
-							break;
-						case 12:
-							if (_TekLexer_compare_consume_lit(lexer, "#fallthrough")) {
-								token = TekToken_directive_fallthrough;
-							}
-							break;
-						case 14:
-							if (_TekLexer_compare_consume_lit(lexer, "#compound_type")) {
-								token = TekToken_directive_compound_type;
-							}
-							break;
-						default:
-							break;
+					token = TekLexerKeyword_find((uint8_t*)lexer->code + ident_start_idx, ident_len, code_end);
+					if (token != TekToken_ident) {
+						_TekLexer_advance_column(lexer, ident_len);
 					}
 
 					if (is_directive && token == TekToken_ident) {
@@ -936,16 +1379,18 @@ TOKEN_END:
 			_TekLexer_advance_column(lexer, 1);
 		}
 
-		TekLexer_token_add(lexer, file, token, code_idx_start, lexer->code_idx, line_start, column_start);
+		TekLexer_token_add(lexer, file, token, code_idx_start, lexer->code_idx);
+		//
+		// only TekLexer_relex passes in a resync, so keep this out of the way of a full lex.
+		if (tek_unlikely(resync != NULL) && _TekLexer_resync_check(file, resync)) {
+			*open_brackets_count_in_out = open_brackets_count;
+			return tek_true;
+		}
 	}
 
-	TekLexer_token_add(lexer, file, TekToken_end_of_file, lexer->code_idx, lexer->code_idx, lexer->line, lexer->column);
-
-	//
-	// success, so now lets queue to job to make a syntax tree.
-	TekJob* j = TekCompiler_job_queue(c, TekJobType_gen_syn_file);
-	j->file_id = file_id;
+	TekLexer_token_add(lexer, file, TekToken_end_of_file, lexer->code_idx, lexer->code_idx);
 
+	*open_brackets_count_in_out = open_brackets_count;
 	return tek_true;
 BAIL_INCORRECT_CLOSE_BRACKET: {}
 	TekTokenOpenBracket* open_bracket = &open_brackets[open_brackets_count - 1];
@@ -959,7 +1404,7 @@ BAIL:
 
 	// add the token that failed to the tokens stack so the reference
 	// to the error location in error.args[0] will work.
-	TekLexer_token_add(lexer, file, token, code_idx_start, lexer->code_idx, line_start, column_start);
+	TekLexer_token_add(lexer, file, token, code_idx_start, lexer->code_idx);
 
 	//
 	// add the rest of the new line start indices to line_code_start_indices
@@ -977,3 +1422,772 @@ BAIL_PUSH_ERROR:
 	return tek_false;
 }
 
+
+TekBool TekLexer_lex(TekLexer* lexer, TekCompiler* c, TekFileId file_id) {
+	TekTokenOpenBracket open_brackets[tek_lexer_cap_open_brackets] = {0};
+	uint32_t open_brackets_count = 0;
+
+	//
+	// reset the lexer
+	tek_zero_elmt(lexer);
+
+	TekFile* file = TekCompiler_file_get(c, file_id);
+
+	//
+	// setup the lexer to use the file
+	lexer->code = file->code;
+	lexer->code_len = file->size;
+
+	file->flags &= ~TekFileFlags_is_bracket_mismatched;
+	file->relex_token_idx = 0;
+	file->relex_line_idx = 0;
+	file->relex_values_count = 0;
+	file->relex_code_idx_shift = 0;
+
+	if (!_TekLexer_lex(lexer, c, file, open_brackets, &open_brackets_count, NULL)) {
+		return tek_false;
+	}
+
+	//
+	// success, so now lets queue to job to make a syntax tree.
+	TekJob* j = TekCompiler_job_queue(c, TekJobType_gen_syn_file);
+	j->file_id = file_id;
+
+	return tek_true;
+}
+
+//
+// @return: the location of an old token with the shift that is still to be added to it, see TekLexerResync.
+static inline TekTokenLocCompact _TekLexerResync_old_loc(TekLexerResync* resync, uint32_t token_idx) {
+	TekTokenLocCompact loc = resync->old_token_locs[token_idx];
+	loc.code_idx_start += resync->old_code_idx_shift;
+	loc.code_idx_end += resync->old_code_idx_shift;
+	return loc;
+}
+
+static TekBool _TekLexer_resync_check(TekFile* file, TekLexerResync* resync) {
+	if (file->tokens_count >= resync->tokens_cap || file->token_values_count >= resync->values_cap) {
+		resync->is_out_of_room = tek_true;
+		return tek_true;
+	}
+
+	uint32_t token_idx = file->tokens_count - 1;
+	TekTokenLocCompact loc = _TekFile_token_locs(file)[token_idx];
+	if (loc.code_idx_start < resync->edit_end_code_idx) {
+		return tek_false;
+	}
+
+	//
+	// step over the old tokens that start before the new one, the edit has changed how they are lexed.
+	intptr_t old_code_idx_start = (intptr_t)loc.code_idx_start - resync->code_idx_shift;
+	while (resync->old_token_idx < resync->old_tokens_end_idx && (intptr_t)_TekLexerResync_old_loc(resync, resync->old_token_idx).code_idx_start < old_code_idx_start) {
+		resync->old_token_idx += 1;
+	}
+	if (resync->old_token_idx == resync->old_tokens_end_idx) {
+		return tek_false;
+	}
+
+	//
+	// the code after the edit has not changed, so once a token is lexed the same as an old one,
+	// every token after it will be too.
+	TekTokenLocCompact old_loc = _TekLexerResync_old_loc(resync, resync->old_token_idx);
+	if (
+		resync->old_tokens[resync->old_token_idx] != TekFile_tokens(file)[token_idx] ||
+		(intptr_t)old_loc.code_idx_start != old_code_idx_start ||
+		(intptr_t)old_loc.code_idx_end != (intptr_t)loc.code_idx_end - resync->code_idx_shift
+	) {
+		return tek_false;
+	}
+
+	resync->old_token_idx += 1;
+	resync->is_synced = tek_true;
+	return tek_true;
+}
+
+//
+// @return: the number of tokens from @param(start_idx) up to @param(end_idx) that have a value, see TekToken_has_value.
+static uint32_t _TekLexer_values_count(TekToken* tokens, uint32_t start_idx, uint32_t end_idx) {
+	uint8_t* pos = &tokens[start_idx];
+	uint8_t* end = &tokens[end_idx];
+	uint32_t count = 0;
+	//
+	// the tokens that have a value are all of the ones from TekToken_ident to TekToken_lit_string apart from TekToken_end_of_file.
+#if TEK_LEXER_SIMD && defined(__AVX2__)
+	__m256i ident_32 = _mm256_set1_epi8((char)TekToken_ident);
+	__m256i last_offset_32 = _mm256_set1_epi8(TekToken_lit_string - TekToken_ident);
+	__m256i end_of_file_offset_32 = _mm256_set1_epi8(TekToken_end_of_file - TekToken_ident);
+	while (end - pos >= 32) {
+		__m256i offsets = _mm256_sub_epi8(_mm256_loadu_si256((__m256i*)pos), ident_32);
+		__m256i has_value = _mm256_andnot_si256(
+			_mm256_cmpeq_epi8(offsets, end_of_file_offset_32),
+			_mm256_cmpeq_epi8(_mm256_min_epu8(offsets, last_offset_32), offsets));
+		count += __builtin_popcount(_mm256_movemask_epi8(has_value));
+		pos += 32;
+	}
+#endif
+#if TEK_LEXER_SIMD && defined(__SSE2__)
+	__m128i ident_16 = _mm_set1_epi8((char)TekToken_ident);
+	__m128i last_offset_16 = _mm_set1_epi8(TekToken_lit_string - TekToken_ident);
+	__m128i end_of_file_offset_16 = _mm_set1_epi8(TekToken_end_of_file - TekToken_ident);
+	while (end - pos >= 16) {
+		__m128i offsets = _mm_sub_epi8(_mm_loadu_si128((__m128i*)pos), ident_16);
+		__m128i has_value = _mm_andnot_si128(
+			_mm_cmpeq_epi8(offsets, end_of_file_offset_16),
+			_mm_cmpeq_epi8(_mm_min_epu8(offsets, last_offset_16), offsets));
+		count += __builtin_popcount(_mm_movemask_epi8(has_value));
+		pos += 16;
+	}
+#endif
+	while (pos < end) {
+		count += TekToken_has_value(*pos);
+		pos += 1;
+	}
+	return count;
+}
+
+//
+// @return: the number of token values before @param(token_idx). they are counted from whichever is the closest
+//          out of the first token, the last token and where the last TekLexer_relex left off.
+static uint32_t _TekLexer_values_count_at(TekFile* file, uint32_t token_idx) {
+	uint32_t known_token_idx = file->relex_token_idx;
+	uint32_t known_values_count = file->relex_values_count;
+	uint32_t distance = token_idx > known_token_idx ? token_idx - known_token_idx : known_token_idx - token_idx;
+	if (token_idx < distance) {
+		known_token_idx = 0;
+		known_values_count = 0;
+		distance = token_idx;
+	}
+	if (file->tokens_count - token_idx < distance) {
+		known_token_idx = file->tokens_count;
+		known_values_count = file->token_values_count;
+	}
+
+	TekToken* tokens = TekFile_tokens(file);
+	if (token_idx >= known_token_idx) {
+		return known_values_count + _TekLexer_values_count(tokens, known_token_idx, token_idx);
+	}
+	return known_values_count - _TekLexer_values_count(tokens, token_idx, known_token_idx);
+}
+
+//
+// moves where the shift that TekLexer_relex leaves on the token locations and line starts begins, so it begins
+// somewhere from @param(token_idx) to @param(token_end_idx) and from @param(line_idx) to @param(line_end_idx).
+// the locations and line starts that it moves over are shifted for real, so this costs as much as how far it moves,
+// which is how far this edit is from the last one.
+static void _TekLexer_relex_shift_move(TekFile* file, uint32_t token_idx, uint32_t token_end_idx, uint32_t line_idx, uint32_t line_end_idx) {
+	uint32_t shift = file->relex_code_idx_shift;
+	if (shift == 0) {
+		return;
+	}
+
+	TekToken* tokens = TekFile_tokens(file);
+	TekTokenLocCompact* token_locs = _TekFile_token_locs(file);
+	if (file->relex_token_idx < token_idx) {
+		file->relex_values_count += _TekLexer_values_count(tokens, file->relex_token_idx, token_idx);
+		for (uint32_t idx = file->relex_token_idx; idx < token_idx; idx += 1) {
+			token_locs[idx].code_idx_start += shift;
+			token_locs[idx].code_idx_end += shift;
+		}
+		file->relex_token_idx = token_idx;
+	} else if (file->relex_token_idx > token_end_idx) {
+		file->relex_values_count -= _TekLexer_values_count(tokens, token_end_idx, file->relex_token_idx);
+		for (uint32_t idx = token_end_idx; idx < file->relex_token_idx; idx += 1) {
+			token_locs[idx].code_idx_start -= shift;
+			token_locs[idx].code_idx_end -= shift;
+		}
+		file->relex_token_idx = token_end_idx;
+	}
+
+	uintptr_t* line_code_start_indices = _TekFile_line_code_start_indices(file);
+	intptr_t line_shift = (int32_t)shift;
+	if (file->relex_line_idx < line_idx) {
+		for (uint32_t idx = file->relex_line_idx; idx < line_idx; idx += 1) {
+			line_code_start_indices[idx] += line_shift;
+		}
+		file->relex_line_idx = line_idx;
+	} else if (file->relex_line_idx > line_end_idx) {
+		for (uint32_t idx = line_end_idx; idx < file->relex_line_idx; idx += 1) {
+			line_code_start_indices[idx] -= line_shift;
+		}
+		file->relex_line_idx = line_end_idx;
+	}
+}
+
+//
+// works out the brackets that are still open before @param(token_idx) from the bracket_matches.
+// it walks back from the token and jumps over every bracketed body that was closed before it,
+// so it only looks at the open brackets and the tokens around them that are not in a closed body.
+// @return: the number of open brackets written to @param(open_brackets), the outer most one first.
+static uint32_t _TekLexer_open_brackets_at(TekFile* file, uint32_t token_idx, TekTokenOpenBracket* open_brackets) {
+	TekToken* tokens = TekFile_tokens(file);
+	uint32_t count = 0;
+	uint32_t idx = token_idx;
+	while (idx > 0) {
+		idx -= 1;
+		TekToken token = tokens[idx];
+		switch (token) {
+			case '(':
+			case '{':
+			case '[':
+				tek_assert(count < tek_lexer_cap_open_brackets, "maximum number of open brackets has been reached: %u", tek_lexer_cap_open_brackets);
+				open_brackets[count] = (TekTokenOpenBracket){ .token = token, .token_idx = idx };
+				count += 1;
+				break;
+			case ')':
+			case '}':
+			case ']':
+				idx = TekFile_bracket_open_idx(file, idx);
+				break;
+		}
+	}
+
+	for (uint32_t i = 0; i < count / 2; i += 1) {
+		TekTokenOpenBracket open_bracket = open_brackets[i];
+		open_brackets[i] = open_brackets[count - 1 - i];
+		open_brackets[count - 1 - i] = open_bracket;
+	}
+	return count;
+}
+
+//
+// replays the open bracket stack over tokens that have already been lexed and counts the tokens that have a value.
+// the lexer has already checked the brackets, so every close bracket matches the stack.
+static void _TekLexer_brackets_replay(TekToken* tokens, uint32_t start_idx, uint32_t end_idx, TekTokenOpenBracket* open_brackets, uint32_t* open_brackets_count_in_out, uint32_t* values_count_in_out) {
+	uint32_t open_brackets_count = *open_brackets_count_in_out;
+	uint32_t values_count = *values_count_in_out;
+	for (uint32_t idx = start_idx; idx < end_idx; idx += 1) {
+		TekToken token = tokens[idx];
+		switch (token) {
+			case '(':
+			case '{':
+			case '[':
+				tek_assert(open_brackets_count < tek_lexer_cap_open_brackets, "maximum number of open brackets has been reached: %u", tek_lexer_cap_open_brackets);
+				open_brackets[open_brackets_count] = (TekTokenOpenBracket){ .token = token, .token_idx = idx };
+				open_brackets_count += 1;
+				break;
+			case ')':
+			case '}':
+			case ']':
+				tek_debug_assert(open_brackets_count > 0, "the old tokens have a close bracket that does not match");
+				open_brackets_count -= 1;
+				break;
+			default:
+				values_count += TekToken_has_value(token);
+				break;
+		}
+	}
+
+	*open_brackets_count_in_out = open_brackets_count;
+	*values_count_in_out = values_count;
+}
+
+//
+// @return: the index of the first line from @param(low) up to @param(high) that starts after @param(code_idx),
+//          or @param(high) if there is none.
+static uint32_t _TekLexer_line_upper_bound(TekFile* file, uint32_t low, uint32_t high, uintptr_t code_idx) {
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		if (TekFile_line_code_start_idx(file, mid) <= code_idx) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+//
+// @return: the index of the first token that ends at or after @param(code_idx).
+static uint32_t _TekLexer_token_end_lower_bound(TekFile* file, uint32_t count, uintptr_t code_idx) {
+	uint32_t low = 0;
+	uint32_t high = count;
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		if (TekFile_token_loc_compact(file, mid).code_idx_end < code_idx) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+//
+// @return: the index of the first token that starts at or after @param(code_idx).
+static uint32_t _TekLexer_token_start_lower_bound(TekFile* file, uint32_t count, uintptr_t code_idx) {
+	uint32_t low = 0;
+	uint32_t high = count;
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		if (TekFile_token_loc_compact(file, mid).code_idx_start < code_idx) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+//
+// finds where the lines start in the code after @param(code_idx), the same way _TekLexer_advance_line does,
+// and stops before @param(end_code_idx). they are written to @param(line_code_start_indices) when it is not NULL.
+// @return: the number of line starts that were found
+static uint32_t _TekLexer_line_starts_find(TekFile* file, uintptr_t code_idx, uintptr_t end_code_idx, uintptr_t* line_code_start_indices) {
+	uint8_t* code = (uint8_t*)file->code;
+	uint8_t* pos = code + code_idx;
+	uint8_t* end = code + tek_min(end_code_idx, file->size);
+	uint32_t count = 0;
+	while (1) {
+		pos += _TekLexer_count_until_any(pos, end, '\n', '\r', '\n', '\r');
+		if (pos == end) {
+			break;
+		}
+
+		uintptr_t line_code_start_idx = pos - code + 1;
+		if (*pos == '\r') {
+			if (line_code_start_idx == file->size) {
+				break;
+			}
+			line_code_start_idx += code[line_code_start_idx] == '\n';
+		}
+		if (line_code_start_idx >= end_code_idx) {
+			break;
+		}
+
+		if (line_code_start_indices) {
+			line_code_start_indices[count] = line_code_start_idx;
+		}
+		count += 1;
+		pos = code + line_code_start_idx;
+	}
+	return count;
+}
+
+//
+// puts the old line starts after the resync back in after the new ones, that have been written over the old ones from the restart on.
+// @param(synced_code_idx) is the end of the token that the resync matched, where the old lines start moving by @param(code_idx_shift).
+// the old ones that the new ones have been written over are found again in the code. there are only as many of them
+// as there are new lines, so this does not look at the code any further than the lexer would if the old ones were kept.
+// @return: the index of the first old line start, which still has the shift of TekFile.relex_code_idx_shift to be added to it.
+static uint32_t _TekLexer_relex_lines_splice(TekFile* file, uint32_t old_lines_count, uintptr_t synced_code_idx, intptr_t code_idx_shift) {
+	uintptr_t* line_code_start_indices = _TekFile_line_code_start_indices(file);
+	uint32_t lines_count = file->lines_count;
+	uintptr_t old_synced_code_idx = synced_code_idx - code_idx_shift;
+	if (lines_count < old_lines_count && TekFile_line_code_start_idx(file, lines_count) <= old_synced_code_idx) {
+		//
+		// the new lines have not reached the old ones after the resync, so move those down to after the new ones.
+		uint32_t old_line_idx = _TekLexer_line_upper_bound(file, lines_count, old_lines_count, old_synced_code_idx);
+		uint32_t count = old_lines_count - old_line_idx;
+		tek_copy_elmts(&line_code_start_indices[lines_count], &line_code_start_indices[old_line_idx], count);
+		file->lines_count = lines_count + count;
+
+		count = old_lines_count - file->lines_count;
+		tek_zero_elmts(&line_code_start_indices[file->lines_count], count);
+		return lines_count;
+	}
+
+	uintptr_t end_code_idx = file->size + 1;
+	uint32_t count = 0;
+	if (lines_count < old_lines_count) {
+		end_code_idx = TekFile_line_code_start_idx(file, lines_count) + code_idx_shift;
+		count = old_lines_count - lines_count;
+	}
+
+	uint32_t found_count = _TekLexer_line_starts_find(file, synced_code_idx, end_code_idx, NULL);
+	tek_copy_elmts(&line_code_start_indices[lines_count + found_count], &line_code_start_indices[lines_count], count);
+	_TekLexer_line_starts_find(file, synced_code_idx, end_code_idx, &line_code_start_indices[lines_count]);
+	file->lines_count = lines_count + found_count + count;
+	return lines_count + found_count;
+}
+
+//
+// moves @param(count) tokens along with their locations and bracket matches from @param(src_idx) to @param(dst_idx).
+static void _TekLexer_relex_tokens_move(TekFile* file, uint32_t dst_idx, uint32_t src_idx, uint32_t count) {
+	tek_copy_elmts(&TekFile_tokens(file)[dst_idx], &TekFile_tokens(file)[src_idx], count);
+	tek_copy_elmts(&_TekFile_token_locs(file)[dst_idx], &_TekFile_token_locs(file)[src_idx], count);
+	tek_copy_elmts(&TekFile_bracket_matches(file)[dst_idx], &TekFile_bracket_matches(file)[src_idx], count);
+}
+
+//
+// zeroes the tokens along with their locations and bracket matches from @param(idx) up to @param(end_idx).
+// a segment is expected to be zero past what is used, so this is done to everything the relex has written past the end.
+static void _TekLexer_relex_tokens_zero(TekFile* file, uint32_t idx, uint32_t end_idx) {
+	if (idx >= end_idx) {
+		return;
+	}
+	uint32_t count = end_idx - idx;
+	tek_zero_elmts(&TekFile_tokens(file)[idx], count);
+	tek_zero_elmts(&_TekFile_token_locs(file)[idx], count);
+	tek_zero_elmts(&TekFile_bracket_matches(file)[idx], count);
+}
+
+//
+// sets up the lexer to carry on lexing the file from @param(code_idx), which is the start of a token on line @param(line).
+// the column is counted from 0 on the first line.
+static void _TekLexer_relex_lexer_setup(TekLexer* lexer, TekFile* file, uintptr_t code_idx, uint32_t line) {
+	tek_zero_elmt(lexer);
+	lexer->code = file->code;
+	lexer->code_len = file->size;
+	lexer->code_idx = code_idx;
+	lexer->line = line;
+	lexer->column = line
+		? code_idx - TekFile_line_code_start_idx(file, line - 1) + 1
+		: code_idx;
+}
+
+TekLexerRelexResult TekLexer_relex(TekLexer* lexer, TekCompiler* c, TekFileId file_id, TekLexerEdit* edit, TekLexerRelexSpan* span_out) {
+	TekFile* file = TekCompiler_file_get(c, file_id);
+	tek_assert(edit->code_idx <= file->size && edit->deleted_len <= file->size - edit->code_idx, "the edit goes past the end of the code");
+
+	//
+	// the edit is made in place, so the edited code has to fit in the file's code_buf
+	// and have no more bytes than the file's segments have been sized for.
+	uintptr_t code_size_max = (uintptr_t)1 << (file->seg_class + TekFileSegClass_min_code_size_log2);
+	uintptr_t size = file->size - edit->deleted_len + edit->inserted_len;
+	uintptr_t code_buf_size = tek_min(code_size_max, file->segment_sizes[TekMemSegFile_code_buf]);
+	if (file->size > code_buf_size || size > code_buf_size) {
+		return TekLexerRelexResult_no_room;
+	}
+
+	TekTokenLocCompact* token_locs = _TekFile_token_locs(file);
+	TekToken* tokens = TekFile_tokens(file);
+	TekValue* token_values = TekFile_token_values(file);
+	uint32_t* bracket_matches = TekFile_bracket_matches(file);
+	uintptr_t* line_code_start_indices = _TekFile_line_code_start_indices(file);
+	uint32_t old_tokens_count = file->tokens_count;
+	uint32_t old_token_values_count = file->token_values_count;
+	uint32_t old_lines_count = file->lines_count;
+	uintptr_t edit_start_idx = edit->code_idx;
+	uintptr_t old_edit_end_idx = edit->code_idx + edit->deleted_len;
+	uintptr_t edit_end_idx = edit->code_idx + edit->inserted_len;
+	intptr_t code_idx_shift = (intptr_t)edit->inserted_len - (intptr_t)edit->deleted_len;
+
+	//
+	// restart from the token before the first one that reaches the edit,
+	// as that token could have been lexed differently if the code after it was different.
+	// if the last lex did not get to the end of the file or left a bracket that does not match,
+	// then nothing can be reused and the whole file is lexed again.
+	TekTokenOpenBracket open_brackets[tek_lexer_cap_open_brackets];
+	uint32_t open_brackets_count = 0;
+	uint32_t restart_token_idx = 0;
+	uint32_t restart_values_count = 0;
+	uint32_t restart_lines_count = 0;
+	uintptr_t restart_code_idx = 0;
+	uint32_t old_token_idx = 0;
+	TekBool is_complete =
+		old_tokens_count && tokens[old_tokens_count - 1] == TekToken_end_of_file &&
+		!(file->flags & TekFileFlags_is_bracket_mismatched);
+	if (is_complete) {
+		restart_token_idx = _TekLexer_token_end_lower_bound(file, old_tokens_count, edit_start_idx);
+		restart_token_idx = restart_token_idx ? restart_token_idx - 1 : 0;
+		old_token_idx = _TekLexer_token_start_lower_bound(file, old_tokens_count, old_edit_end_idx);
+		old_token_idx = tek_max(old_token_idx, restart_token_idx);
+		restart_code_idx = restart_token_idx ? TekFile_token_loc_compact(file, restart_token_idx).code_idx_start : 0;
+		restart_lines_count = _TekLexer_line_upper_bound(file, 0, old_lines_count, restart_code_idx);
+		uint32_t old_line_idx = _TekLexer_line_upper_bound(file, restart_lines_count, old_lines_count, old_edit_end_idx);
+
+		//
+		// the tokens and lines before the restart are kept where they are, so none of them can be left with a shift.
+		// and the old ones after the edit are all moved by this edit together, so they all need to have the same shift.
+		_TekLexer_relex_shift_move(file, restart_token_idx, old_token_idx, restart_lines_count, old_line_idx);
+		restart_values_count = _TekLexer_values_count_at(file, restart_token_idx);
+
+		//
+		// apart from the tokens themselves, the only state the lexer keeps between tokens is the open bracket stack.
+		open_brackets_count = _TekLexer_open_brackets_at(file, restart_token_idx, open_brackets);
+	}
+	TekTokenOpenBracket restart_open_brackets[tek_lexer_cap_open_brackets];
+	uint32_t restart_open_brackets_count = open_brackets_count;
+	tek_copy_elmts(restart_open_brackets, open_brackets, open_brackets_count);
+
+	//
+	// make the edit to the code, if the file is an overlay or memory mapped then it is copied into the code_buf first.
+	// the mapping is not needed after that.
+	char* code = TekFile_code_buf(file);
+	if (file->code != code) {
+		tek_copy_bytes(code, file->code, file->size);
+		if (file->flags & TekFileFlags_is_mapped) {
+			tek_virt_mem_release(file->code, file->size);
+			tek_virt_mem_map_file_close(file->handle);
+		}
+		file->code = code;
+		file->flags &= ~(TekFileFlags_is_overlay | TekFileFlags_is_mapped);
+	}
+	tek_copy_bytes(code + edit_end_idx, code + old_edit_end_idx, file->size - old_edit_end_idx);
+	tek_copy_bytes(code + edit_start_idx, edit->inserted, edit->inserted_len);
+	if (size < file->size) {
+		tek_zero_bytes(code + size, file->size - size);
+	}
+	file->size = size;
+
+	//
+	// the new tokens and values are lexed into the spare space past the old ones, so the old ones after the edit are left where they are.
+	// the slot before the new tokens is a copy of the token before the restart, as the lexer looks back at it.
+	// splicing the new tokens in can take up to twice as much spare space as they do, see below.
+	uint32_t scratch_token_idx = old_tokens_count + 1;
+	uint32_t scratch_value_idx = old_token_values_count;
+	uint32_t tokens_cap = tek_min(
+		file->segment_sizes[TekMemSegFile_token_locs] / sizeof(TekTokenLocCompact),
+		tek_min(file->segment_sizes[TekMemSegFile_tokens] / sizeof(TekToken), file->segment_sizes[TekMemSegFile_bracket_matches] / sizeof(uint32_t)));
+	uint32_t values_cap = file->segment_sizes[TekMemSegFile_token_values] / sizeof(TekValue);
+
+	TekBool is_success;
+	TekBool is_lexed_in_place = !is_complete || tokens_cap < scratch_token_idx + 8 || values_cap < scratch_value_idx + 8;
+	uint32_t removed_count = old_tokens_count - restart_token_idx;
+	uint32_t added_count = 0;
+	TekErrorKind bracket_error_kind = TekErrorKind_none;
+	uint32_t bracket_error_token_idx = 0;
+	uint32_t bracket_error_open_token_idx = 0;
+	if (!is_lexed_in_place) {
+		TekLexerResync resync = {
+			.old_tokens = tokens,
+			.old_token_locs = token_locs,
+			.edit_end_code_idx = edit_end_idx,
+			.code_idx_shift = code_idx_shift,
+			.old_code_idx_shift = file->relex_code_idx_shift,
+			.restart_token_idx = restart_token_idx,
+			.old_token_idx = old_token_idx,
+			.old_tokens_end_idx = old_tokens_count,
+			.tokens_cap = restart_token_idx + (tokens_cap - scratch_token_idx) / 2 - 2,
+			.values_cap = restart_values_count + (values_cap - scratch_value_idx) / 2 - 2,
+		};
+
+		//
+		// lex into a copy of the file that has its token and value segments moved along,
+		// so the new ones have the same indices in the spare space that they will have once they are spliced in.
+		TekFile scratch_file = *file;
+		scratch_file.segments[TekMemSegFile_token_locs] = &token_locs[scratch_token_idx - restart_token_idx];
+		scratch_file.segments[TekMemSegFile_tokens] = &tokens[scratch_token_idx - restart_token_idx];
+		scratch_file.segments[TekMemSegFile_bracket_matches] = &bracket_matches[scratch_token_idx - restart_token_idx];
+		scratch_file.segments[TekMemSegFile_token_values] = &token_values[scratch_value_idx - restart_values_count];
+		scratch_file.tokens_count = restart_token_idx;
+		scratch_file.token_values_count = restart_values_count;
+		scratch_file.lines_count = restart_lines_count;
+		if (restart_token_idx) {
+			tokens[scratch_token_idx - 1] = tokens[restart_token_idx - 1];
+			token_locs[scratch_token_idx - 1] = token_locs[restart_token_idx - 1];
+		}
+
+		_TekLexer_relex_lexer_setup(lexer, file, restart_code_idx, restart_lines_count);
+		is_success = _TekLexer_lex(lexer, c, &scratch_file, open_brackets, &open_brackets_count, &resync);
+
+		//
+		// the lexer writes the line starts in place and can join a new line on to the end of the token before the restart.
+		file->flags = scratch_file.flags;
+		file->lines_count = scratch_file.lines_count;
+		if (restart_token_idx) {
+			token_locs[restart_token_idx - 1] = token_locs[scratch_token_idx - 1];
+		}
+		added_count = scratch_file.tokens_count - restart_token_idx;
+		uint32_t added_values_count = scratch_file.token_values_count - restart_values_count;
+		uint32_t scratch_tokens_end_idx = scratch_token_idx + added_count;
+		uint32_t scratch_values_end_idx = scratch_value_idx + added_values_count;
+
+		if (resync.is_out_of_room) {
+			//
+			// there are so many new tokens that they may not fit, so throw them away and lex the rest of the file in place.
+			// this only happens once the relex has already lexed a large part of the file.
+			_TekLexer_relex_tokens_zero(file, scratch_token_idx - 1, scratch_tokens_end_idx);
+			tek_zero_elmts(&token_values[scratch_value_idx], added_values_count);
+			open_brackets_count = restart_open_brackets_count;
+			tek_copy_elmts(open_brackets, restart_open_brackets, open_brackets_count);
+			is_lexed_in_place = tek_true;
+		} else if (is_success && resync.is_synced) {
+			//
+			// the new tokens have caught up with the old ones, so the old ones from the resync on are kept.
+			// rebuild the open bracket stack the old tokens had there, to find the closes after it that matched brackets before it.
+			uint32_t synced_token_idx = resync.old_token_idx;
+			uintptr_t synced_code_idx = token_locs[scratch_tokens_end_idx - 1].code_idx_end;
+			uint32_t synced_values_count = restart_values_count;
+			_TekLexer_brackets_replay(tokens, restart_token_idx, synced_token_idx, restart_open_brackets, &restart_open_brackets_count, &synced_values_count);
+
+			uint32_t old_close_token_indices[tek_lexer_cap_open_brackets];
+			uint32_t old_closes_count = 0;
+			for (uint32_t idx = restart_open_brackets_count; idx > 0; idx -= 1) {
+				uint32_t close_token_idx = TekFile_bracket_close_idx(file, restart_open_brackets[idx - 1].token_idx);
+				if (close_token_idx == 0) {
+					break;
+				}
+				old_close_token_indices[old_closes_count] = close_token_idx;
+				old_closes_count += 1;
+			}
+
+			uint32_t line_idx = _TekLexer_relex_lines_splice(file, old_lines_count, synced_code_idx, code_idx_shift);
+
+			//
+			// move the old tokens after the resync along to straight after the new ones, then the new ones in before them.
+			// when the old ones would be moved on to the new ones, the new ones are moved out of the way first.
+			uint32_t tokens_end_idx = restart_token_idx + added_count;
+			uint32_t count = old_tokens_count - synced_token_idx;
+			uint32_t tokens_count = tokens_end_idx + count;
+			if (tokens_count > scratch_token_idx) {
+				_TekLexer_relex_tokens_move(file, tokens_count, scratch_token_idx, added_count);
+				scratch_token_idx = tokens_count;
+				scratch_tokens_end_idx = tokens_count + added_count;
+			}
+			_TekLexer_relex_tokens_move(file, tokens_end_idx, synced_token_idx, count);
+			_TekLexer_relex_tokens_move(file, restart_token_idx, scratch_token_idx, added_count);
+			_TekLexer_relex_tokens_zero(file, tokens_count, scratch_tokens_end_idx);
+
+			uint32_t values_end_idx = restart_values_count + added_values_count;
+			count = old_token_values_count - synced_values_count;
+			uint32_t values_count = values_end_idx + count;
+			if (values_count > scratch_value_idx) {
+				tek_copy_elmts(&token_values[values_count], &token_values[scratch_value_idx], added_values_count);
+				scratch_value_idx = values_count;
+				scratch_values_end_idx = values_count + added_values_count;
+			}
+			tek_copy_elmts(&token_values[values_end_idx], &token_values[synced_values_count], count);
+			tek_copy_elmts(&token_values[restart_values_count], &token_values[scratch_value_idx], added_values_count);
+			if (values_count < scratch_values_end_idx) {
+				count = scratch_values_end_idx - values_count;
+				tek_zero_elmts(&token_values[values_count], count);
+			}
+
+			file->tokens_count = tokens_count;
+			file->token_values_count = values_count;
+			file->relex_token_idx = tokens_end_idx;
+			file->relex_line_idx = line_idx;
+			file->relex_values_count = values_end_idx;
+			file->relex_code_idx_shift += (uint32_t)code_idx_shift;
+			removed_count = synced_token_idx - restart_token_idx;
+
+			//
+			// the old pairs after the resync have not changed. the old closes that matched brackets before the resync
+			// now match the brackets that are open at the end of the new tokens, as long as they are the same kind.
+			uint32_t token_idx_shift = tokens_end_idx - synced_token_idx;
+			for (uint32_t idx = 0; idx < old_closes_count; idx += 1) {
+				uint32_t close_token_idx = old_close_token_indices[idx] + token_idx_shift;
+				if (open_brackets_count == 0) {
+					bracket_error_kind = TekErrorKind_lexer_no_open_brackets_to_close;
+					bracket_error_token_idx = close_token_idx;
+					break;
+				}
+
+				TekTokenOpenBracket* open_bracket = &open_brackets[open_brackets_count - 1];
+				TekToken close = tokens[close_token_idx];
+				TekToken open_variant = close == ')' ? '(' : close == '}' ? '{' : '[';
+				if (open_bracket->token != open_variant) {
+					bracket_error_kind = TekErrorKind_lexer_invalid_close_bracket;
+					bracket_error_token_idx = close_token_idx;
+					bracket_error_open_token_idx = open_bracket->token_idx;
+					break;
+				}
+
+				open_brackets_count -= 1;
+				uint32_t distance = close_token_idx - open_bracket->token_idx;
+				bracket_matches[open_bracket->token_idx] = distance;
+				bracket_matches[close_token_idx] = distance;
+			}
+		} else {
+			//
+			// the lexing got to the end of the code without lining up with the old tokens or it stopped at an error,
+			// so all of the old tokens from the restart on have been replaced.
+			_TekLexer_relex_tokens_move(file, restart_token_idx, scratch_token_idx, added_count);
+			file->tokens_count = restart_token_idx + added_count;
+			_TekLexer_relex_tokens_zero(file, file->tokens_count, scratch_tokens_end_idx);
+
+			tek_copy_elmts(&token_values[restart_values_count], &token_values[scratch_value_idx], added_values_count);
+			file->token_values_count = restart_values_count + added_values_count;
+			uint32_t count = scratch_values_end_idx - file->token_values_count;
+			tek_zero_elmts(&token_values[file->token_values_count], count);
+
+			if (file->lines_count < old_lines_count) {
+				count = old_lines_count - file->lines_count;
+				tek_zero_elmts(&line_code_start_indices[file->lines_count], count);
+			}
+
+			file->relex_token_idx = 0;
+			file->relex_line_idx = 0;
+			file->relex_values_count = 0;
+			file->relex_code_idx_shift = 0;
+		}
+
+		if (is_success && !resync.is_out_of_room) {
+			//
+			// the lexer could not write the matches into the brackets that were open before the restart,
+			// as they are not in the spare space, so copy them from the closes.
+			for (uint32_t idx = restart_token_idx; idx < restart_token_idx + added_count; idx += 1) {
+				TekToken token = tokens[idx];
+				if (token != ')' && token != '}' && token != ']') {
+					continue;
+				}
+				uint32_t open_token_idx = TekFile_bracket_open_idx(file, idx);
+				if (open_token_idx < restart_token_idx) {
+					bracket_matches[open_token_idx] = bracket_matches[idx];
+				}
+			}
+		}
+	}
+
+	if (is_lexed_in_place) {
+		//
+		// lex the rest of the file straight over the old tokens, none of which are kept.
+		// the brackets that are open at the restart could have been closed by the old tokens, so they are cleared.
+		for (uint32_t idx = 0; idx < open_brackets_count; idx += 1) {
+			bracket_matches[open_brackets[idx].token_idx] = 0;
+		}
+		if (restart_token_idx < old_tokens_count) {
+			uint32_t count = old_tokens_count - restart_token_idx;
+			tek_zero_elmts(&bracket_matches[restart_token_idx], count);
+		}
+
+		file->tokens_count = restart_token_idx;
+		file->token_values_count = restart_values_count;
+		file->lines_count = restart_lines_count;
+		_TekLexer_relex_lexer_setup(lexer, file, restart_code_idx, restart_lines_count);
+		is_success = _TekLexer_lex(lexer, c, file, open_brackets, &open_brackets_count, NULL);
+
+		_TekLexer_relex_tokens_zero(file, file->tokens_count, old_tokens_count);
+		if (file->token_values_count < old_token_values_count) {
+			uint32_t count = old_token_values_count - file->token_values_count;
+			tek_zero_elmts(&token_values[file->token_values_count], count);
+		}
+		if (file->lines_count < old_lines_count) {
+			uint32_t count = old_lines_count - file->lines_count;
+			tek_zero_elmts(&line_code_start_indices[file->lines_count], count);
+		}
+
+		file->flags &= ~TekFileFlags_is_bracket_mismatched;
+		file->relex_token_idx = 0;
+		file->relex_line_idx = 0;
+		file->relex_values_count = 0;
+		file->relex_code_idx_shift = 0;
+		removed_count = old_tokens_count - restart_token_idx;
+		added_count = file->tokens_count - restart_token_idx;
+	}
+
+	//
+	// the string_buf is only scratch space for the lexer, so it is decommitted the same as after the lex stage.
+	tek_virt_mem_decommit(TekFile_string_buf(file), file->segment_sizes[TekMemSegFile_string_buf]);
+
+	if (span_out) {
+		span_out->token_idx = restart_token_idx;
+		span_out->removed_count = removed_count;
+		span_out->added_count = added_count;
+	}
+
+	if (!is_success) {
+		return TekLexerRelexResult_error;
+	}
+
+	if (bracket_error_kind != TekErrorKind_none) {
+		file->flags |= TekFileFlags_is_bracket_mismatched;
+		TekError* error = TekCompiler_error_add(c, bracket_error_kind);
+		error->args[0].file_id = file_id;
+		error->args[0].token_idx = bracket_error_token_idx;
+		if (bracket_error_kind == TekErrorKind_lexer_invalid_close_bracket) {
+			error->args[1].file_id = file_id;
+			error->args[1].token_idx = bracket_error_open_token_idx;
+		}
+		return TekLexerRelexResult_error;
+	}
+
+	//
+	// the brackets that are still open were never closed, the ones from before the restart had their old matches.
+	for (uint32_t idx = 0; idx < open_brackets_count; idx += 1) {
+		bracket_matches[open_brackets[idx].token_idx] = 0;
+	}
+
+	return TekLexerRelexResult_ok;
+}
@@ -12,9 +12,13 @@
 #include "util.c"
 
 int main(int argc, char** argv) {
-	TekCompileArgs compile_args;
+	TekCompileArgs compile_args = {0};
+	CmdArgerBool mem_report = cmd_arger_false;
+	int64_t mem_limit_mb = 0;
 
 	CmdArgerDesc optional_args[] = {
+		cmd_arger_desc_integer(&mem_limit_mb, "mem_limit", "roughly the most memory in megabytes that files being compiled can use at once. compiles slower instead of running out of memory, 0 is no limit"),
+		cmd_arger_desc_flag(&mem_report, "mem_report", "print the memory used by each segment kind and the peak resident memory after compiling"),
 	};
 	CmdArgerDesc required_args[] = {
 		cmd_arger_desc_string(&compile_args.file_path, "file_path", "path to the main source file you wish to compile"),
@@ -25,6 +29,7 @@ int main(int argc, char** argv) {
 		optional_args, sizeof(optional_args) / sizeof(*optional_args),
 		required_args, sizeof(required_args) / sizeof(*required_args),
 		argc, argv, app_name_and_version);
+	compile_args.mem_limit = mem_limit_mb > 0 ? (uintptr_t)mem_limit_mb * Tek1MB : 0;
 
 
 	int threads_count = 1;
@@ -45,6 +50,12 @@ int main(int argc, char** argv) {
 		printf("%.*s", error_string.count, error_string.TekStk_data);
 	}
 
+	if (mem_report) {
+		TekStk(char) report_string = {0};
+		TekCompiler_mem_report(c, &report_string);
+		printf("%.*s", report_string.count, report_string.TekStk_data);
+	}
+
 	return 0;
 }
 
@@ -214,3 +214,36 @@ char* TekAbi_strings[TekProcCallConv_COUNT] = {
 	[TekAbi_c] = "TekAbi_c",
 };
 
+
+char* TekMemSegCompiler_strings[TekMemSegCompiler_COUNT] = {
+	[TekMemSegCompiler_compiler_struct] = "compiler_struct",
+	[TekMemSegCompiler_workers] = "workers",
+	[TekMemSegCompiler_libs] = "libs",
+	[TekMemSegCompiler_file_paths] = "file_paths",
+	[TekMemSegCompiler_files] = "files",
+	[TekMemSegCompiler_strtab_hashes] = "strtab_hashes",
+	[TekMemSegCompiler_strtab_entries] = "strtab_entries",
+	[TekMemSegCompiler_strtab_strings] = "strtab_strings",
+	[TekMemSegCompiler_jobs] = "jobs",
+	[TekMemSegCompiler_errors] = "errors",
+	[TekMemSegCompiler_overlay_path_str_ids] = "overlay_path_str_ids",
+	[TekMemSegCompiler_seg_group_pool] = "seg_group_pool",
+};
+
+char* TekMemSegLib_strings[TekMemSegLib_COUNT] = {
+	[TekMemSegLib_files] = "files",
+	[TekMemSegLib_dependers] = "dependers",
+	[TekMemSegLib_dependencies] = "dependencies",
+};
+
+char* TekMemSegFile_strings[TekMemSegFile_COUNT] = {
+	[TekMemSegFile_token_locs] = "token_locs",
+	[TekMemSegFile_tokens] = "tokens",
+	[TekMemSegFile_token_values] = "token_values",
+	[TekMemSegFile_bracket_matches] = "bracket_matches",
+	[TekMemSegFile_string_buf] = "string_buf",
+	[TekMemSegFile_line_code_start_indices] = "line_code_start_indices",
+	[TekMemSegFile_syntax_tree_nodes] = "syntax_tree_nodes",
+	[TekMemSegFile_syntax_tree_array_node_indices] = "syntax_tree_array_node_indices",
+	[TekMemSegFile_code_buf] = "code_buf",
+};
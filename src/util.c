@@ -9,6 +9,7 @@
 #include <linux/futex.h>
 #include <sys/time.h>
 #include <sys/mman.h> // mmap etc
+#include <sys/resource.h> // getrusage
 #endif
 
 
@@ -785,7 +786,7 @@ void _TekPool_reset(_TekPool* pool, uintptr_t elmt_size) {
 	uintptr_t cap = pool->cap;
 	for (uintptr_t i = 0; i < cap; i += 1) {
 		// + 2 instead of 1 because we use id's here and not indexes.
-		*(uintptr_t*)tek_ptr_add(elmts, i * elmt_size) = i + 2;
+		*(uint32_t*)tek_ptr_add(elmts, i * elmt_size) = i + 2;
 	}
 	pool->count = 0;
 	pool->free_list_head_id = 1;
@@ -1094,8 +1095,8 @@ void _TekKVStk_remove_shift(_TekKVStk* kv_stk, uint32_t idx, uint32_t key_size,
 		void* key_dst = _TekKVStk_get_key(kv_stk, idx, key_size);
 		void* value_dst = _TekKVStk_get_value(kv_stk, idx, key_size, key_align, value_size, value_align);
 
-		tek_copy_bytes(key_dst, tek_ptr_add(key_dst, key_size), (uintptr_t)(kv_stk->count - idx) * (uintptr_t)key_size);
-		tek_copy_bytes(value_dst, tek_ptr_add(value_dst, value_size), (uintptr_t)(kv_stk->count - idx) * (uintptr_t)value_size);
+		tek_copy_bytes(key_dst, tek_ptr_add(key_dst, key_size), (uintptr_t)(kv_stk->count - idx - 1) * (uintptr_t)key_size);
+		tek_copy_bytes(value_dst, tek_ptr_add(value_dst, value_size), (uintptr_t)(kv_stk->count - idx - 1) * (uintptr_t)value_size);
 	}
 
 	kv_stk->count -= 1;
@@ -1306,7 +1307,58 @@ TekBool tek_virt_mem_release(void* addr, uintptr_t size) {
 	return tek_true;
 }
 
-void* tek_virt_mem_map_file(char* path, TekVirtMemProtection protection, uintptr_t* size_out, TekVirtMemFileHandle* file_handle_out) {
+TekBool tek_virt_mem_huge_pages_advise(void* addr, uintptr_t size) {
+#ifdef MADV_HUGEPAGE
+	return madvise(addr, size, MADV_HUGEPAGE) == 0;
+#else
+	return tek_true;
+#endif
+}
+
+uintptr_t tek_virt_mem_resident_size(void* addr, uintptr_t size) {
+#ifdef __linux__
+	uintptr_t page_size = tek_virt_mem_page_size();
+	uintptr_t resident_size = 0;
+
+	//
+	// mincore gives us a byte per page, so go through the range a chunk at a time
+	// so we do not need a huge vector for the very large reservations.
+	unsigned char vec[4096];
+	uintptr_t chunk_size = sizeof(vec) * page_size;
+	for (uintptr_t offset = 0; offset < size; offset += chunk_size) {
+		uintptr_t size_remaining = size - offset;
+		uintptr_t size_to_check = size_remaining < chunk_size ? size_remaining : chunk_size;
+		if (mincore((char*)addr + offset, size_to_check, vec) != 0) {
+			return size;
+		}
+
+		uintptr_t pages_count = size_to_check / page_size;
+		for (uintptr_t i = 0; i < pages_count; i += 1) {
+			resident_size += (vec[i] & 1) * page_size;
+		}
+	}
+
+	return resident_size;
+#else
+	return size;
+#endif
+}
+
+uintptr_t tek_process_peak_resident_size() {
+#ifdef __linux__
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+
+	// ru_maxrss is in kilobytes on linux
+	return (uintptr_t)usage.ru_maxrss * 1024;
+#else
+	return 0;
+#endif
+}
+
+void* tek_virt_mem_map_file(char* path, TekVirtMemProtection protection, TekVirtMemMapAdvice advice, uintptr_t* size_out, TekVirtMemFileHandle* file_handle_out) {
 	if (protection == TekVirtMemProtection_no_access)
 		tek_abort("cannot map a file with no access");
 
@@ -1333,11 +1385,25 @@ void* tek_virt_mem_map_file(char* path, TekVirtMemProtection protection, uintptr
 	if (fstat(fd, &s) != 0) return 0;
 	uintptr_t size = s.st_size;
 
-	void* addr = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+	int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+	if (advice == TekVirtMemMapAdvice_populate) {
+		flags |= MAP_POPULATE;
+	}
+#endif
+
+	void* addr = mmap(NULL, size, prot, flags, fd, 0);
 	if (addr == MAP_FAILED) {
 		close(fd);
 		return NULL;
 	}
+
+	//
+	// the advice is only a hint, so failing to apply it is not an error.
+	if (advice == TekVirtMemMapAdvice_sequential) {
+		madvise(addr, size, MADV_SEQUENTIAL);
+		madvise(addr, size, MADV_WILLNEED);
+	}
 	*size_out = size;
 	*file_handle_out = fd;
 	return addr;
@@ -1367,62 +1433,75 @@ TekVirtMemError TekLinearAlctor_init(TekLinearAlctor* alctor) {
 	void* data = tek_virt_mem_reserve(NULL, TekLinearAlctor_cap, TekVirtMemProtection_read_write);
 	if (data == NULL) return tek_virt_mem_get_last_error();
 	alctor->data = data;
+	alctor->pos = data;
 	return 0;
 }
 
 void TekLinearAlctor_deinit(TekLinearAlctor* alctor) {
 	tek_virt_mem_release(alctor->data, TekLinearAlctor_cap);
 	alctor->data = NULL;
+	alctor->pos = NULL;
 }
 
 void TekLinearAlctor_reset(TekLinearAlctor* alctor) {
-	tek_virt_mem_decommit(alctor->data, TekLinearAlctor_cap);
+	//
+	// only the pages up to the position have been touched, so only decommit those.
+	// this gives the memory back to the OS and it will be zeroed apon next access.
+	uintptr_t used_size = (uintptr_t)tek_ptr_round_up_align((void*)tek_ptr_diff(alctor->pos, alctor->data), tek_virt_mem_page_size());
+	if (used_size) {
+		tek_virt_mem_decommit(alctor->data, used_size);
+	}
+	alctor->pos = alctor->data;
 }
 
 void* TekLinearAlctor_alloc(TekLinearAlctor* alctor, uintptr_t size, uintptr_t align) {
-	tek_abort("unimplemented");
-	/*
-	while (1) {
-		// an allocation gets the pointer by adding the position to the start of the buffer.
-		void* ptr = tek_ptr_add(md.arena, alctor->pos);
-		// rounds up the pointer so it aligned as requested.
-		ptr = tek_ptr_round_up_align(ptr, align);
-
-		uintptr_t next_pos = tek_ptr_diff(ptr, md.arena) + size;
-		// checks to see if it fits in the arena.
-		if (next_pos <= md.size) {
-			// and just increments the position for the next allocation.
-			alctor->pos = next_pos;
-			return ptr;
-		} else {
-			uintptr_t arena_size = TekLinearAlctor_min_arena_size;
-			if (size > TekLinearAlctor_min_arena_size) {
-				arena_size = size;
-			}
-			TekLinearAlctor_alloc_next_arena(alctor, arena_size);
-		}
+	// rounds up the position so the allocation is aligned as requested.
+	void* ptr = tek_ptr_round_up_align(alctor->pos, align);
+
+	// checks to see if it fits in the reserved memory.
+	void* next_pos = tek_ptr_add(ptr, size);
+	if (next_pos > tek_ptr_add(alctor->data, TekLinearAlctor_cap)) {
+		return NULL;
 	}
-	*/
+
+	// and just increments the position for the next allocation.
+	alctor->pos = next_pos;
+	return ptr;
 }
 
 void* TekLinearAlctor_TekAlctor_fn(void* alctor_data, void* ptr, uintptr_t old_size, uintptr_t size, uintptr_t align) {
-	tek_abort("unimplemented");
-	/*
 	TekLinearAlctor* alctor = alctor_data;
 	if (!ptr && size == 0) {
 		TekLinearAlctor_reset(alctor);
 	} else if (!ptr) {
 		return TekLinearAlctor_alloc(alctor, size, align);
 	} else if (ptr && size > 0) {
-		void* new_ptr =  TekLinearAlctor_alloc(alctor, size, align);
-		tek_copy_bytes(new_ptr, ptr, tek_min(old_size, size));
+		//
+		// if this is the last allocation, it can just grow or shrink in place.
+		// the memory past the old size has never been handed out so it is still zeroed.
+		if (tek_ptr_add(ptr, old_size) == alctor->pos && size >= old_size) {
+			void* next_pos = tek_ptr_add(ptr, size);
+			if (next_pos > tek_ptr_add(alctor->data, TekLinearAlctor_cap)) {
+				return NULL;
+			}
+			alctor->pos = next_pos;
+			return ptr;
+		}
+
+		if (size <= old_size) {
+			return ptr;
+		}
+
+		void* new_ptr = TekLinearAlctor_alloc(alctor, size, align);
+		if (new_ptr) {
+			tek_copy_bytes(new_ptr, ptr, old_size);
+		}
 		return new_ptr;
 	} else {
-		// ignore deallocate
+		// ignore deallocate, everything is freed at once with a reset.
 	}
 
 	return NULL;
-	*/
 }
 
 //===========================================================================================
@@ -1616,6 +1695,35 @@ ERR: {}
     return err;
 }
 
+int tek_file_size(char* path, uintptr_t* size_out) {
+	struct stat s = {0};
+	if (stat(path, &s) != 0) return errno;
+	*size_out = s.st_size;
+	return 0;
+}
+
+int tek_file_read_into(char* path, void* buf, uintptr_t size) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) return errno;
+
+	//
+	// read can return less than we asked for, so keep going until we have it all.
+	while (size) {
+		ssize_t read_size = read(fd, buf, size);
+		if (read_size == -1 && errno == EINTR) continue;
+		if (read_size <= 0) {
+			int err = read_size == 0 ? EIO : errno;
+			close(fd);
+			return err;
+		}
+		buf = tek_ptr_add(buf, read_size);
+		size -= read_size;
+	}
+
+	if (close(fd) != 0) return errno;
+	return 0;
+}
+
 int tek_file_write(char* path, void* data, uintptr_t size) {
 	FILE* file = fopen(path, "w");
     if (file == NULL) { return errno; }
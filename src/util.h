@@ -143,6 +143,7 @@ static inline void* tek_ptr_round_down_align(void* ptr, uintptr_t align) {
 #define tek_ptr_diff(to, from) ((char*)(to) - (char*)(from))
 #define tek_zero_elmt(ptr) memset(ptr, 0, sizeof(*(ptr)))
 #define tek_zero_elmts(ptr, elmts_count) memset(ptr, 0, sizeof(*(ptr)) * (elmts_count))
+#define tek_zero_bytes(ptr, byte_count) memset(ptr, 0, byte_count)
 #define tek_copy_bytes(dst, src, byte_count) memmove(dst, src, byte_count)
 #define tek_copy_elmts(dst, src, elmts_count) memmove(dst, src, elmts_count * sizeof(*(dst)))
 
@@ -724,7 +725,7 @@ struct _TekKVStk {
 		uint32_t cap; \
 	} TekKVStk_##K##_##V;
 
-#define TekKVStk_init(kv_stk, cap) _TekKVStk_init((_TekKVStk*)kv_stk, cap, sizeof((kv_stk)->TekKVStk_data->k), alignof(typeof((kv_stk)->TekKVStk_data->k)), sizeof(*(kv_stk)->TekKVStk_data->v), alignof(typeof((kv_stk)->TekKVStk_data->v)))
+#define TekKVStk_init(kv_stk, cap) _TekKVStk_init((_TekKVStk*)kv_stk, cap, sizeof((kv_stk)->TekKVStk_data->k), alignof(typeof((kv_stk)->TekKVStk_data->k)), sizeof((kv_stk)->TekKVStk_data->v), alignof(typeof((kv_stk)->TekKVStk_data->v)))
 void _TekKVStk_init(_TekKVStk* kv_stk, uint32_t cap, uint32_t key_size, uint32_t key_align, uint32_t value_size, uint32_t value_align);
 
 #define TekKVStk_deinit(kv_stk) _TekKVStk_deinit((_TekKVStk*)kv_stk, sizeof((kv_stk)->TekKVStk_data->k), alignof(typeof((kv_stk)->TekKVStk_data->k)), sizeof((kv_stk)->TekKVStk_data->v), alignof(typeof((kv_stk)->TekKVStk_data->v)))
@@ -920,12 +921,58 @@ TekBool tek_virt_mem_decommit(void* addr, uintptr_t size);
 //
 TekBool tek_virt_mem_release(void* addr, uintptr_t size);
 
+//
+// asks the OS to back the range of memory with transparent huge pages.
+// this is only advice, so on platforms without them this does nothing and returns tek_true.
+//
+// @param addr: the start of the pages you wish to advise.
+//             must be a aligned to whatever tek_virt_mem_page_size returns.
+//
+// @param size: the size in bytes of the memory you wish to advise.
+//             must be a aligned to whatever tek_virt_mem_page_size returns.
+//
+TekBool tek_virt_mem_huge_pages_advise(void* addr, uintptr_t size);
+
+//
+// counts how many bytes of the range of memory are currently backed by physical pages.
+// this is meant for reporting, it walks the page tables so do not call it in a hot path.
+//
+// @param addr: the start of the pages you wish to count.
+//             must be a aligned to whatever tek_virt_mem_page_size returns.
+//
+// @param size: the size in bytes of the memory you wish to count.
+//             must be a aligned to whatever tek_virt_mem_page_size returns.
+//
+// @return: the resident size in bytes, this is always a multiple of tek_virt_mem_page_size.
+//          if the platform cannot tell us, then @param(size) is returned.
+//
+uintptr_t tek_virt_mem_resident_size(void* addr, uintptr_t size);
+
+//
+// @return: the most physical memory in bytes that this process has had resident at one time.
+//          0 is returned if the platform cannot tell us.
+//
+uintptr_t tek_process_peak_resident_size();
+
 #if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
 typedef int TekVirtMemFileHandle;
 #else
 #error "TODO implement virtual memory for this platform"
 #endif
 
+//
+// how the pages of a memory mapped file are brought into memory.
+typedef uint8_t TekVirtMemMapAdvice;
+enum {
+	// the pages are faulted in one at a time apon first access.
+	TekVirtMemMapAdvice_none,
+	// the whole file is read in and mapped before tek_virt_mem_map_file returns.
+	TekVirtMemMapAdvice_populate,
+	// the OS is told the file will be read from start to end, so it can
+	// read ahead aggressively while the caller works through the start of the file.
+	TekVirtMemMapAdvice_sequential,
+};
+
 //
 // maps a file at the path @param(path) into memory.
 // you must use tek_virt_mem_release before calling
@@ -937,6 +984,8 @@ typedef int TekVirtMemFileHandle;
 //
 // @param protection: what the memory is allowed to be used for
 //
+// @param advice: how the pages of the file should be brought into memory
+//
 // @param size_out: apon success, this parameter will be set to the size of the the file
 //
 // @param file_handle_out: apon success, this parameter will be set to the file handle
@@ -945,7 +994,7 @@ typedef int TekVirtMemFileHandle;
 // @return: NULL on failure, otherwise the address pointing to the start of the memory mapped file is returned.
 //          if errored you can get the error by calling tek_virt_mem_get_last_error() directly after this call.
 //
-void* tek_virt_mem_map_file(char* path, TekVirtMemProtection protection, uintptr_t* size_out, TekVirtMemFileHandle* file_handle_out);
+void* tek_virt_mem_map_file(char* path, TekVirtMemProtection protection, TekVirtMemMapAdvice advice, uintptr_t* size_out, TekVirtMemFileHandle* file_handle_out);
 
 //
 // closes the file that was mapped with tek_virt_mem_map_file
@@ -1077,6 +1126,14 @@ int tek_file_path_normalize_resolve(char* path, char* path_buf_out);
 // @return: 0 on success, otherwise the value in "errno" is returned
 int tek_file_read(char* path, TekStk(char)* bytes_out);
 
+// @return: 0 on success, otherwise the value in "errno" is returned
+int tek_file_size(char* path, uintptr_t* size_out);
+
+//
+// reads @param(size) bytes from the start of the file into @param(buf).
+// @return: 0 on success, otherwise the value in "errno" is returned
+int tek_file_read_into(char* path, void* buf, uintptr_t size);
+
 // @return: 0 on success, otherwise the value in "errno" is returned
 int tek_file_write(char* path, void* data, uintptr_t size);
 